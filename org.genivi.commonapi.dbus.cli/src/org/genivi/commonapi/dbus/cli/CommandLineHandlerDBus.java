@@ -121,6 +121,42 @@ public class CommandLineHandlerDBus extends AbstractCommandLineHandler implement
 			if (parsedArguments.hasOption("nsc")) {
 				cliTool.disableSyncCalls();
 			}
+			// Generate compile-time method dispatch in stub adapters
+			if (parsedArguments.hasOption("sd")) {
+				cliTool.enableStaticDispatch();
+			}
+			// Generate C++20 awaitable variants of the asynchronous proxy methods
+			if (parsedArguments.hasOption("co")) {
+				cliTool.enableCoroutines();
+			}
+			// Explicitly instantiate the stub adapter templates in their source files
+			if (parsedArguments.hasOption("ei")) {
+				cliTool.enableExplicitInstantiation();
+			}
+			// Generate a unity source file per model
+			if (parsedArguments.hasOption("u")) {
+				cliTool.enableUnityFiles();
+			}
+			// Record per-method call statistics in proxies and stub adapters
+			if (parsedArguments.hasOption("st")) {
+				cliTool.enableStatistics();
+			}
+			// Export the statistics of stub adapters as org.genivi.commonapi.Statistics
+			if (parsedArguments.hasOption("si")) {
+				cliTool.enableStatisticsInterface();
+			}
+			// Generate beginAttributeBatch() and commitAttributeBatch() in stub adapters
+			if (parsedArguments.hasOption("ab")) {
+				cliTool.enableAttributeBatch();
+			}
+			// Skip unchanged interfaces and files
+			if (parsedArguments.hasOption("inc")) {
+				cliTool.enableIncrementalGeneration();
+			}
+			// -j --jobs number of generator threads
+			if (parsedArguments.hasOption("j")) {
+				cliTool.setGeneratorJobs(parsedArguments.getOptionValue("j"));
+			}
 			// print out generated files
 			if (parsedArguments.hasOption("pf")) {
 				cliTool.listGeneratedFiles();
@@ -317,6 +317,69 @@ public class DBusCommandlineToolMain extends CommandlineTool {
 				PreferenceConstantsDBus.P_GENERATE_SYNC_CALLS_DBUS, "false");
 	}
 
+	public void enableStaticDispatch() {
+		ConsoleLogger.printLog("Code generation for static stub dispatch is on");
+		dbusPref.setPreference(
+				PreferenceConstantsDBus.P_GENERATE_STATIC_DISPATCH_DBUS, "true");
+	}
+
+	public void enableCoroutines() {
+		ConsoleLogger.printLog("Code generation for C++20 awaitable proxy methods is on");
+		dbusPref.setPreference(
+				PreferenceConstantsDBus.P_GENERATE_COROUTINES_DBUS, "true");
+	}
+
+	public void enableExplicitInstantiation() {
+		ConsoleLogger.printLog("Code generation for explicit stub adapter instantiations is on");
+		dbusPref.setPreference(
+				PreferenceConstantsDBus.P_GENERATE_EXPLICIT_INSTANTIATION_DBUS, "true");
+	}
+
+	public void enableUnityFiles() {
+		ConsoleLogger.printLog("Code generation for unity source files is on");
+		dbusPref.setPreference(
+				PreferenceConstantsDBus.P_GENERATE_UNITY_DBUS, "true");
+	}
+
+	public void enableStatistics() {
+		ConsoleLogger.printLog("Code generation for per-method call statistics is on");
+		dbusPref.setPreference(
+				PreferenceConstantsDBus.P_GENERATE_STATISTICS_DBUS, "true");
+	}
+
+	public void enableStatisticsInterface() {
+		ConsoleLogger.printLog("Code generation for the statistics interface of stub adapters is on");
+		dbusPref.setPreference(
+				PreferenceConstantsDBus.P_GENERATE_STATISTICS_INTERFACE_DBUS, "true");
+	}
+
+	public void enableAttributeBatch() {
+		ConsoleLogger.printLog("Code generation for attribute change batches in stub adapters is on");
+		dbusPref.setPreference(
+				PreferenceConstantsDBus.P_GENERATE_ATTRIBUTE_BATCH_DBUS, "true");
+	}
+
+	public void enableIncrementalGeneration() {
+		ConsoleLogger.printLog("Incremental code generation is on");
+		dbusPref.setPreference(
+				PreferenceConstantsDBus.P_GENERATE_INCREMENTAL_DBUS, "true");
+	}
+
+	public void setGeneratorJobs(String optionValue) {
+		try {
+			int jobs = Integer.parseInt(optionValue);
+			if (jobs < 1) {
+				throw new NumberFormatException();
+			}
+			ConsoleLogger.printLog("Generating code with " + jobs + " threads");
+			dbusPref.setPreference(PreferenceConstantsDBus.P_GENERATOR_JOBS_DBUS,
+					Integer.toString(jobs));
+		} catch (NumberFormatException e) {
+			ConsoleLogger.printErrorLog("Invalid number of generator threads: "
+					+ optionValue);
+		}
+	}
+
 	/**
 	 * Set the text from a file which will be inserted as a comment in each
 	 * generated file (for example your license)
@@ -128,6 +128,13 @@ public class DBusGenerationCommand  extends GenerationCommand {
 		instance.setPreference(PreferenceConstantsDBus.P_GENERATE_STUB_DBUS, generatStub);
 		instance.setPreference(PreferenceConstantsDBus.P_GENERATE_DEPENDENCIES_DBUS, generatInclude);
 		instance.setPreference(PreferenceConstantsDBus.P_GENERATE_SYNC_CALLS_DBUS, generatSyncCalls);
+		instance.setPreference(PreferenceConstantsDBus.P_GENERATE_STATIC_DISPATCH_DBUS, store.getString(PreferenceConstantsDBus.P_GENERATE_STATIC_DISPATCH_DBUS));
+		instance.setPreference(PreferenceConstantsDBus.P_GENERATE_COROUTINES_DBUS, store.getString(PreferenceConstantsDBus.P_GENERATE_COROUTINES_DBUS));
+		instance.setPreference(PreferenceConstantsDBus.P_GENERATE_EXPLICIT_INSTANTIATION_DBUS, store.getString(PreferenceConstantsDBus.P_GENERATE_EXPLICIT_INSTANTIATION_DBUS));
+		instance.setPreference(PreferenceConstantsDBus.P_GENERATE_UNITY_DBUS, store.getString(PreferenceConstantsDBus.P_GENERATE_UNITY_DBUS));
+		instance.setPreference(PreferenceConstantsDBus.P_GENERATE_STATISTICS_DBUS, store.getString(PreferenceConstantsDBus.P_GENERATE_STATISTICS_DBUS));
+		instance.setPreference(PreferenceConstantsDBus.P_GENERATE_STATISTICS_INTERFACE_DBUS, store.getString(PreferenceConstantsDBus.P_GENERATE_STATISTICS_INTERFACE_DBUS));
+		instance.setPreference(PreferenceConstantsDBus.P_GENERATE_ATTRIBUTE_BATCH_DBUS, store.getString(PreferenceConstantsDBus.P_GENERATE_ATTRIBUTE_BATCH_DBUS));
 	}   
 
 }
@@ -41,5 +41,12 @@ public class PreferenceInitializerDBus extends AbstractPreferenceInitializer
         store.setDefault(PreferenceConstantsDBus.P_GENERATE_DEPENDENCIES_DBUS, true);
         store.setDefault(PreferenceConstantsDBus.P_ENABLE_DBUS_VALIDATOR, true);
         store.setDefault(PreferenceConstantsDBus.P_GENERATE_SYNC_CALLS_DBUS, true);
+        store.setDefault(PreferenceConstantsDBus.P_GENERATE_STATIC_DISPATCH_DBUS, false);
+        store.setDefault(PreferenceConstantsDBus.P_GENERATE_COROUTINES_DBUS, false);
+        store.setDefault(PreferenceConstantsDBus.P_GENERATE_EXPLICIT_INSTANTIATION_DBUS, false);
+        store.setDefault(PreferenceConstantsDBus.P_GENERATE_UNITY_DBUS, false);
+        store.setDefault(PreferenceConstantsDBus.P_GENERATE_STATISTICS_DBUS, false);
+        store.setDefault(PreferenceConstantsDBus.P_GENERATE_STATISTICS_INTERFACE_DBUS, false);
+        store.setDefault(PreferenceConstantsDBus.P_GENERATE_ATTRIBUTE_BATCH_DBUS, false);
     }
 }
@@ -108,6 +108,56 @@ public class PropertyAccessor extends org.genivi.commonapi.core.deployment.Prope
             if (isUnixFD == null) isUnixFD = false;
 		return isUnixFD;
 	}	
+	public Boolean getDBusAttributeCaching (FAttribute obj) {
+		Boolean isCached = false;
+		try {
+			if (type_ == DeploymentType.INTERFACE)
+				isCached = dbusInterface_.getDBusAttributeCaching(obj);
+		}
+		catch (java.lang.NullPointerException e) {}
+		if (isCached == null) isCached = false;
+		return isCached;
+	}
+	public Boolean getDBusSharedBuffer (FArgument obj) {
+		Boolean isShared = false;
+		try {
+			if (type_ == DeploymentType.INTERFACE)
+				isShared = dbusInterface_.getDBusSharedBuffer(obj);
+		}
+		catch (java.lang.NullPointerException e) {}
+		if (isShared == null) isShared = false;
+		return isShared;
+	}
+	public Boolean getDBusPrefetchAttributes (FInterface obj) {
+		Boolean isPrefetched = false;
+		try {
+			if (type_ == DeploymentType.INTERFACE)
+				isPrefetched = dbusInterface_.getDBusPrefetchAttributes(obj);
+		}
+		catch (java.lang.NullPointerException e) {}
+		if (isPrefetched == null) isPrefetched = false;
+		return isPrefetched;
+	}
+	public Integer getDBusMaxInFlightCalls (FInterface obj) {
+		Integer maxInFlightCalls = 0;
+		try {
+			if (type_ == DeploymentType.INTERFACE)
+				maxInFlightCalls = dbusInterface_.getDBusMaxInFlightCalls(obj);
+		}
+		catch (java.lang.NullPointerException e) {}
+		if (maxInFlightCalls == null || maxInFlightCalls < 0) maxInFlightCalls = 0;
+		return maxInFlightCalls;
+	}
+	public Integer getDBusCallQueueSize (FInterface obj) {
+		Integer callQueueSize = 256;
+		try {
+			if (type_ == DeploymentType.INTERFACE)
+				callQueueSize = dbusInterface_.getDBusCallQueueSize(obj);
+		}
+		catch (java.lang.NullPointerException e) {}
+		if (callQueueSize == null || callQueueSize < 0) callQueueSize = 256;
+		return callQueueSize;
+	}
 	public DBusVariantType getDBusVariantType (EObject obj) {
 		DBusVariantType variantType = DBusVariantType.CommonAPI;
 		try {
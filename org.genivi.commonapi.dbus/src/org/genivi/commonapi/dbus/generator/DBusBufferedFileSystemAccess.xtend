@@ -0,0 +1,85 @@
+/* Copyright (C) 2015 BMW Group
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+package org.genivi.commonapi.dbus.generator
+
+import java.io.File
+import java.nio.charset.Charset
+import java.nio.file.Files
+import java.util.ArrayList
+import java.util.Arrays
+import java.util.List
+import java.util.Map
+import org.eclipse.xtext.generator.IFileSystemAccess
+import org.eclipse.xtext.generator.OutputConfiguration
+
+/**
+ * Collects the files generated for one interface or type collection, so that
+ * they can be produced on a worker thread and written in a fixed order later.
+ */
+class DBusBufferedFileSystemAccess implements IFileSystemAccess {
+    val List<String> outputConfigurations_ = new ArrayList<String>()
+    val List<String> fileNames_ = new ArrayList<String>()
+    val List<CharSequence> contents_ = new ArrayList<CharSequence>()
+
+    override generateFile(String fileName, CharSequence contents) {
+        generateFile(fileName, IFileSystemAccess.DEFAULT_OUTPUT, contents)
+    }
+
+    override generateFile(String fileName, String outputConfigurationName, CharSequence contents) {
+        outputConfigurations_.add(outputConfigurationName)
+        fileNames_.add(fileName)
+        contents_.add(contents)
+    }
+
+    override deleteFile(String fileName) {
+        outputConfigurations_.add(IFileSystemAccess.DEFAULT_OUTPUT)
+        fileNames_.add(fileName)
+        contents_.add(null)
+    }
+
+    /**
+     * Hands the collected files to the given file system access. If the output
+     * configurations are known, files whose contents did not change are not
+     * written again. Returns the files that belong to the generated component.
+     */
+    def List<File> flushTo(IFileSystemAccess _access, Map<String, OutputConfiguration> _outputs) {
+        val List<File> files = new ArrayList<File>()
+        for (i : 0 ..< fileNames_.size) {
+            val fileName = fileNames_.get(i)
+            val contents = contents_.get(i)
+            if (contents == null) {
+                _access.deleteFile(fileName)
+            } else {
+                val File file = _outputs.getFile(outputConfigurations_.get(i), fileName)
+                if (file == null || !file.hasContents(contents)) {
+                    _access.generateFile(fileName, outputConfigurations_.get(i), contents)
+                }
+                if (file != null) {
+                    files.add(file)
+                }
+            }
+        }
+        return files
+    }
+
+    def private File getFile(Map<String, OutputConfiguration> _outputs, String _outputConfiguration, String _fileName) {
+        if (_outputs == null || !_outputs.containsKey(_outputConfiguration)) {
+            return null
+        }
+        return new File(_outputs.get(_outputConfiguration).outputDirectory, _fileName)
+    }
+
+    def private boolean hasContents(File _file, CharSequence _contents) {
+        if (!_file.isFile) {
+            return false
+        }
+        // A different encoding only makes the file look changed, so it is written again.
+        val expected = _contents.toString.getBytes(Charset.defaultCharset)
+        if (_file.length != expected.length) {
+            return false
+        }
+        return Arrays.equals(Files.readAllBytes(_file.toPath), expected)
+    }
+}
@@ -0,0 +1,81 @@
+/* Copyright (C) 2015 BMW Group
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+package org.genivi.commonapi.dbus.generator
+
+import java.io.File
+import java.io.FileInputStream
+import java.io.FileOutputStream
+import java.io.IOException
+import java.util.List
+import java.util.Properties
+
+/**
+ * Remembers, per interface or type collection, the hash of the inputs the code
+ * was last generated from and the files that were generated. The cache is kept
+ * in the default output directory.
+ */
+class DBusGeneratorCache {
+    static val String FILE_NAME = ".commonapi-dbus-generator.cache"
+    static val String SEPARATOR = "\n"
+
+    val File file_
+    val Properties entries_ = new Properties()
+    var boolean isModified_ = false
+
+    new(File _directory) {
+        file_ = new File(_directory, FILE_NAME)
+        if (file_.isFile) {
+            var FileInputStream input = null
+            try {
+                input = new FileInputStream(file_)
+                entries_.load(input)
+            } catch (IOException e) {
+                System.err.println("Ignoring unreadable generator cache " + file_ + ": " + e.message)
+                entries_.clear
+            } finally {
+                if (input != null) {
+                    input.close
+                }
+            }
+        }
+    }
+
+    /**
+     * True if the component was generated from inputs with the given hash and
+     * all files generated for it still exist.
+     */
+    def boolean isUpToDate(String _key, String _hash) {
+        val entry = entries_.getProperty(_key)
+        if (entry == null) {
+            return false
+        }
+        val List<String> values = entry.split(SEPARATOR)
+        return values.head == _hash && values.tail.forall[new File(it).isFile]
+    }
+
+    def void update(String _key, String _hash, List<File> _files) {
+        entries_.setProperty(_key, (#[_hash] + _files.map[path]).join(SEPARATOR))
+        isModified_ = true
+    }
+
+    def void save() {
+        if (!isModified_) {
+            return
+        }
+        var FileOutputStream output = null
+        try {
+            file_.parentFile?.mkdirs
+            output = new FileOutputStream(file_)
+            entries_.store(output, "CommonAPI D-Bus generator cache")
+            isModified_ = false
+        } catch (IOException e) {
+            System.err.println("Failed to write generator cache " + file_ + ": " + e.message)
+        } finally {
+            if (output != null) {
+                output.close
+            }
+        }
+    }
+}
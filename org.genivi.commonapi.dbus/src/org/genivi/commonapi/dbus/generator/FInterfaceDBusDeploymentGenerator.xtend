@@ -35,6 +35,10 @@ class FInterfaceDBusDeploymentGenerator extends FTypeCollectionDBusDeploymentGen
                 fInterface.generateDeploymentHeader(deploymentAccessor, modelid))
             fileSystemAccess.generateFile(fInterface.dbusDeploymentSourcePath, IFileSystemAccess.DEFAULT_OUTPUT,
                 fInterface.generateDeploymentSource(deploymentAccessor, modelid))
+            if (fInterface.hasDBusSharedBuffers(deploymentAccessor)) {
+                fileSystemAccess.generateFile(dbusSharedBufferHeaderPath, IFileSystemAccess.DEFAULT_OUTPUT,
+                    generateSharedBufferHeader())
+            }
         }
         else {
             // feature: suppress code generation
@@ -69,6 +73,11 @@ class FInterfaceDBusDeploymentGenerator extends FTypeCollectionDBusDeploymentGen
         #include <CommonAPI/DBus/DBusDeployment.hpp>
         #undef COMMONAPI_INTERNAL_COMPILATION
 
+        «IF _interface.hasDBusSharedBuffers(_accessor)»
+            #include <«dbusSharedBufferHeaderPath»>
+        «ENDIF»
+        «_interface.types.generateWireLayoutIncludes(_accessor)»
+
         «_interface.generateVersionNamespaceBegin»
         «_interface.model.generateNamespaceBeginDeclaration»
         «_interface.generateDeploymentNamespaceBegin»
@@ -87,6 +96,11 @@ class FInterfaceDBusDeploymentGenerator extends FTypeCollectionDBusDeploymentGen
             «t.generateDeploymentDeclaration(_interface, _accessor)»
         «ENDFOR»
 
+        // Type-specific wire layouts
+        «FOR t: _interface.types»
+            «t.generateWireLayout(_accessor)»
+        «ENDFOR»
+
         // Attribute-specific deployments
         «FOR a: _interface.attributes»
             «a.generateDeploymentDeclaration(_interface, _accessor)»
@@ -108,6 +122,11 @@ class FInterfaceDBusDeploymentGenerator extends FTypeCollectionDBusDeploymentGen
                 «a.generateDeploymentDeclaration(broadcast, _interface, _accessor)»
             «ENDFOR»
         «ENDFOR»
+        «IF _interface.hasDBusSharedBuffers(_accessor)»
+
+            // Shared buffers are passed as unix file descriptors
+            COMMONAPI_EXPORT extern CommonAPI::DBus::IntegerDeployment sharedBufferDeployment;
+        «ENDIF»
 
 
         «_interface.generateDeploymentNamespaceEnd»
@@ -153,12 +172,193 @@ class FInterfaceDBusDeploymentGenerator extends FTypeCollectionDBusDeploymentGen
                 «a.generateDeploymentDefinition(broadcast, _interface, _accessor)»
             «ENDFOR»
         «ENDFOR»
+        «IF _interface.hasDBusSharedBuffers(_accessor)»
+
+            // Shared buffers are passed as unix file descriptors
+            CommonAPI::DBus::IntegerDeployment sharedBufferDeployment(true);
+        «ENDIF»
 
         «_interface.generateDeploymentNamespaceEnd»
         «_interface.model.generateNamespaceEndDeclaration»
         «_interface.generateVersionNamespaceEnd»
     '''
 
+    // The transfer of shared buffers does not depend on the interface, all interfaces
+    // that use it include this one header.
+    def private getDBusSharedBufferHeaderPath() {
+        "commonapi/dbus/DBusSharedBuffer.hpp"
+    }
+
+    /**
+     * Transfer of input arguments deployed as DBusSharedBuffer. The sender writes the
+     * bytes to a memfd and seals it, so the receiver can map it read-only without
+     * having to fear that it shrinks or changes while it is being read.
+     */
+    def private generateSharedBufferHeader() '''
+        «generateCommonApiDBusLicenseHeader()»
+
+        #ifndef COMMONAPI_DBUS_SHARED_BUFFER_HPP_
+        #define COMMONAPI_DBUS_SHARED_BUFFER_HPP_
+
+        #include <cerrno>
+        #include <cstddef>
+        #include <cstdint>
+        #include <memory>
+
+        #ifdef _WIN32
+        #include <io.h>
+        #else
+        #include <unistd.h>
+        #endif
+        #ifdef __linux__
+        #include <fcntl.h>
+        #include <sys/mman.h>
+        #include <sys/stat.h>
+        #include <sys/syscall.h>
+        #endif
+
+        #include <CommonAPI/ByteBuffer.hpp>
+
+        // Shared buffers need memfd_create and file sealing (Linux 3.17). The system call
+        // is used directly, so the C library does not need to provide a wrapper for it.
+        #if defined(__linux__) && defined(SYS_memfd_create) && defined(F_ADD_SEALS)
+        #define COMMONAPI_DBUS_HAS_SHARED_BUFFERS 1
+        #ifndef MFD_CLOEXEC
+        #define MFD_CLOEXEC 0x0001U
+        #endif
+        #ifndef MFD_ALLOW_SEALING
+        #define MFD_ALLOW_SEALING 0x0002U
+        #endif
+        #endif
+
+        namespace commonapi {
+        namespace dbus {
+
+        // Sealed memfd holding a copy of a byte buffer. Copies share the descriptor,
+        // it is closed with the last of them. Without memfd support it is always invalid,
+        // so calls fail with OUT_OF_MEMORY.
+        class SharedBuffer {
+        public:
+            explicit SharedBuffer(const CommonAPI::ByteBuffer &_buffer)
+                : fd_(new int(create(_buffer)), [](int *_fd) {
+                      if (*_fd >= 0)
+                          ::close(*_fd);
+                      delete _fd;
+                  }) {
+            }
+
+            explicit operator bool() const {
+                return (*fd_ >= 0);
+            }
+
+            uint32_t getFd() const {
+                return static_cast<uint32_t>(*fd_);
+            }
+
+        private:
+            static int create(const CommonAPI::ByteBuffer &_buffer) {
+            #ifdef COMMONAPI_DBUS_HAS_SHARED_BUFFERS
+                int fd = static_cast<int>(::syscall(SYS_memfd_create, "CommonAPI-DBus-SharedBuffer", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+                if (fd < 0)
+                    return -1;
+                std::size_t written = 0;
+                while (written < _buffer.size()) {
+                    ssize_t result = ::write(fd, _buffer.data() + written, _buffer.size() - written);
+                    if (result < 0 && errno == EINTR)
+                        continue;
+                    if (result <= 0) {
+                        ::close(fd);
+                        return -1;
+                    }
+                    written += static_cast<std::size_t>(result);
+                }
+                if (::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0) {
+                    ::close(fd);
+                    return -1;
+                }
+                return fd;
+            #else
+                (void)_buffer;
+                return -1;
+            #endif
+            }
+
+            std::shared_ptr<int> fd_;
+        };
+
+        // Maps a received shared buffer read-only and copies it into _buffer, which is
+        // the only copy the receiver makes. Takes ownership of the descriptor. Fails for
+        // descriptors that are not sealed.
+        inline bool readSharedBuffer(uint32_t _fd, CommonAPI::ByteBuffer &_buffer) {
+            const int fd = static_cast<int>(_fd);
+        #ifdef COMMONAPI_DBUS_HAS_SHARED_BUFFERS
+            const int seals = ::fcntl(fd, F_GET_SEALS);
+            struct stat status;
+            bool isValid = (seals >= 0 && (seals & (F_SEAL_SHRINK | F_SEAL_WRITE)) == (F_SEAL_SHRINK | F_SEAL_WRITE)
+                            && ::fstat(fd, &status) == 0);
+            if (isValid) {
+                const std::size_t size = static_cast<std::size_t>(status.st_size);
+                if (size == 0) {
+                    _buffer.clear();
+                } else {
+                    void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    isValid = (data != MAP_FAILED);
+                    if (isValid) {
+                        const uint8_t *begin = static_cast<const uint8_t *>(data);
+                        _buffer.assign(begin, begin + size);
+                        ::munmap(data, size);
+                    }
+                }
+            }
+            if (fd >= 0)
+                ::close(fd);
+            return isValid;
+        #else
+            (void)_buffer;
+            if (fd >= 0)
+                ::close(fd);
+            return false;
+        #endif
+        }
+
+        // Owns a received shared buffer descriptor until it is read, so the descriptor
+        // is closed on every path that does not get that far.
+        class ReceivedSharedBuffer {
+        public:
+            ReceivedSharedBuffer()
+                : fd_(-1) {
+            }
+
+            ~ReceivedSharedBuffer() {
+                if (fd_ >= 0)
+                    ::close(fd_);
+            }
+
+            void reset(uint32_t _fd) {
+                if (fd_ >= 0)
+                    ::close(fd_);
+                fd_ = static_cast<int>(_fd);
+            }
+
+            bool read(CommonAPI::ByteBuffer &_buffer) {
+                const int fd = fd_;
+                fd_ = -1;
+                return (fd >= 0 && readSharedBuffer(static_cast<uint32_t>(fd), _buffer));
+            }
+
+        private:
+            ReceivedSharedBuffer(const ReceivedSharedBuffer &);
+            ReceivedSharedBuffer &operator=(const ReceivedSharedBuffer &);
+
+            int fd_;
+        };
+
+        } // namespace dbus
+        } // namespace commonapi
+
+        #endif // COMMONAPI_DBUS_SHARED_BUFFER_HPP_
+    '''
+
     def protected dispatch String generateDeploymentDeclaration(FAttribute _attribute, FInterface _interface, PropertyAccessor _accessor) {
         if (_accessor.hasSpecificDeployment(_attribute) || (_attribute.array && _accessor.hasDeployment(_attribute))) {
             return "COMMONAPI_EXPORT extern " + _attribute.getDeploymentType(_interface, true) + " " + _attribute.name + "Deployment;"
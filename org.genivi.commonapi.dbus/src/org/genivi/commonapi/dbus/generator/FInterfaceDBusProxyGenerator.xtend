@@ -27,18 +27,21 @@ import java.util.List
 import org.franca.deploymodel.dsl.fDeploy.FDProvider
 import org.franca.deploymodel.core.FDeployedProvider
 import java.util.LinkedList
+import java.util.LinkedHashMap
 
 class FInterfaceDBusProxyGenerator {
     @Inject private extension FrancaGeneratorExtensions
     @Inject private extension FrancaDBusGeneratorExtensions
 
     var boolean generateSyncCalls = true
+    var boolean generateCoroutines = false
 
     def generateDBusProxy(FInterface fInterface, IFileSystemAccess fileSystemAccess,
         PropertyAccessor deploymentAccessor, List<FDProvider> providers, IResource modelid) {
 
         if(FPreferencesDBus::getInstance.getPreference(PreferenceConstantsDBus::P_GENERATE_CODE_DBUS, "true").equals("true")) {
             generateSyncCalls = FPreferencesDBus::getInstance.getPreference(PreferenceConstantsDBus::P_GENERATE_SYNC_CALLS_DBUS, "true").equals("true")
+            generateCoroutines = FPreferencesDBus::getInstance.getPreference(PreferenceConstantsDBus::P_GENERATE_COROUTINES_DBUS, "false").equals("true")
             fileSystemAccess.generateFile(fInterface.dbusProxyHeaderPath, PreferenceConstantsDBus.P_OUTPUT_PROXIES_DBUS,
                 fInterface.generateDBusProxyHeader(deploymentAccessor, modelid))
             fileSystemAccess.generateFile(fInterface.dbusProxySourcePath, PreferenceConstantsDBus.P_OUTPUT_PROXIES_DBUS,
@@ -94,7 +97,29 @@ class FInterfaceDBusProxyGenerator {
 
         #undef COMMONAPI_INTERNAL_COMPILATION
 
+        «IF fInterface.hasDBusPrefetch(deploymentAccessor) && deploymentAccessor.getDBusPrefetchAttributes(fInterface)»
+            #include <atomic>
+        «ENDIF»
+        «IF fInterface.attributes.exists[isDBusCached(deploymentAccessor)] || fInterface.hasCallPipeline(deploymentAccessor)»
+            #include <future>
+            #include <mutex>
+        «ENDIF»
+        «IF fInterface.hasCallPipeline(deploymentAccessor)»
+            #include <algorithm>
+            #include <condition_variable>
+            #include <functional>
+            #include <memory>
+            #include <thread>
+            #include <vector>
+        «ENDIF»
         #include <string>
+        «IF fInterface.hasCoroutines»
+
+        #ifdef __cpp_impl_coroutine
+        #include <coroutine>
+        #include <tuple>
+        #endif
+        «ENDIF»
 
         # if defined(_MSC_VER)
         #  if _MSC_VER >= 1300
@@ -119,7 +144,18 @@ class FInterfaceDBusProxyGenerator {
                 const CommonAPI::DBus::DBusAddress &_address,
                 const std::shared_ptr<CommonAPI::DBus::DBusProxyConnection> &_connection);
 
+            «IF (fInterface.hasDBusPrefetch(deploymentAccessor) && deploymentAccessor.getDBusPrefetchAttributes(fInterface)) || fInterface.hasCallPipeline(deploymentAccessor)»
+            virtual ~«fInterface.dbusProxyClassName»() {
+                «IF fInterface.hasDBusPrefetch(deploymentAccessor) && deploymentAccessor.getDBusPrefetchAttributes(fInterface)»
+                    getProxyStatusEvent().unsubscribe(prefetchStatusSubscription_);
+                «ENDIF»
+                «IF fInterface.hasCallPipeline(deploymentAccessor)»
+                    closeCallPipeline();
+                «ENDIF»
+            }
+            «ELSE»
             virtual ~«fInterface.dbusProxyClassName»() { }
+            «ENDIF»
 
             «FOR attribute : fInterface.attributes»
             virtual «attribute.generateGetMethodDefinition»;
@@ -138,12 +174,44 @@ class FInterfaceDBusProxyGenerator {
                 virtual «method.generateAsyncDefinition(false)»;
             «ENDIF»
             «ENDFOR»
+            «IF fInterface.hasCoroutines»
+
+        #ifdef __cpp_impl_coroutine
+            // The awaitable methods are only offered by the D-Bus proxy, not by the proxy
+            // that CommonAPI::Runtime::buildProxy wraps around it. Create it with
+            //     std::dynamic_pointer_cast<«fInterface.dbusProxyClassName»>(CommonAPI::DBus::Factory::get()->createProxy(
+            //         _domain, «fInterface.elementName»::getInterface(), _instance, _connectionId))
+            // and co_await the result of «fInterface.methods.findFirst[!isFireAndForget].elementName»Co(...) in the expression that calls it.
+            «FOR method : fInterface.methods.filter[!isFireAndForget]»
+            «method.generateAwaiterClass(fInterface)»
+
+            «method.dbusAwaiterClassName» «method.elementName»Co(«method.generateAwaiterInParameters»const CommonAPI::CallInfo *_info = nullptr);
+            «ENDFOR»
+        #endif
+            «ENDIF»
 
             «FOR managed : fInterface.managedInterfaces»
             virtual CommonAPI::ProxyManager& «managed.proxyManagerGetterName»();
             «ENDFOR»
 
             virtual void getOwnVersion(uint16_t& ownVersionMajor, uint16_t& ownVersionMinor) const;
+            «IF fInterface.hasDBusPrefetch(deploymentAccessor)»
+
+            // Reads all properties with a single GetAll call and fills the local
+            // copies of the cached attributes.
+            virtual void prefetchAttributes(CommonAPI::CallStatus &_status, const CommonAPI::CallInfo *_info = nullptr);
+            «IF deploymentAccessor.getDBusPrefetchAttributes(fInterface)»
+
+            virtual bool isAvailableBlocking() const;
+            «ENDIF»
+            «ENDIF»
+            «IF fInterface.hasCallPipeline(deploymentAccessor)»
+
+            // Asynchronous calls waiting for a free slot of the in-flight window and
+            // calls that were rejected because the queue was full.
+            std::size_t getQueuedCallCount() const;
+            uint64_t getRejectedCallCount() const;
+            «ENDIF»
 
         private:
 
@@ -185,10 +253,11 @@ class FInterfaceDBusProxyGenerator {
                     }
                 «ENDIF»
                 };
-                DBus«attribute.dbusClassVariableName»Attribute «attribute.dbusClassVariableName»;
-                «ELSE»
-                «attribute.dbusClassName(deploymentAccessor, fInterface)» «attribute.dbusClassVariableName»;
                 «ENDIF»
+                «IF attribute.isDBusCached(deploymentAccessor)»
+                «attribute.generateCachedAttributeClass(deploymentAccessor, fInterface)»
+                «ENDIF»
+                «attribute.dbusAttributeMemberClassName(deploymentAccessor, fInterface)» «attribute.dbusClassVariableName»;
             «ENDFOR»
 
             «FOR broadcast : fInterface.broadcasts»
@@ -204,6 +273,42 @@ class FInterfaceDBusProxyGenerator {
             «FOR managed : fInterface.managedInterfaces»
             CommonAPI::DBus::DBusProxyManager «managed.proxyManagerMemberName»;
             «ENDFOR»
+            «IF fInterface.hasDBusPrefetch(deploymentAccessor) && deploymentAccessor.getDBusPrefetchAttributes(fInterface)»
+
+            mutable std::atomic<bool> isPrefetched_;
+            CommonAPI::ProxyStatusEvent::Subscription prefetchStatusSubscription_;
+            «ENDIF»
+            «IF fInterface.hasCallPipeline(deploymentAccessor)»
+
+            typedef std::function<void(const CommonAPI::CallStatus &)> PipelineCompletion_t;
+            typedef std::function<std::future<CommonAPI::CallStatus>(PipelineCompletion_t)> PipelineStart_t;
+
+            struct PipelinedCall {
+                PipelineStart_t start_;
+                PipelineCompletion_t reject_;
+                std::shared_ptr<std::promise<CommonAPI::CallStatus>> promise_;
+            };
+
+            // Shared with the reply callbacks, which may outlive the proxy.
+            struct CallPipeline {
+                std::mutex mutex_;
+                std::vector<PipelinedCall> queue_;
+                std::size_t head_ = 0;
+                std::size_t queued_ = 0;
+                std::size_t inFlight_ = 0;
+                uint64_t rejected_ = 0;
+                bool isClosed_ = false;
+                // Threads that currently start a queued call on the proxy.
+                std::vector<std::thread::id> starting_;
+                std::condition_variable startDone_;
+            };
+
+            std::future<CommonAPI::CallStatus> pipelineCall(PipelineStart_t _start, PipelineCompletion_t _reject);
+            static void completePipelinedCall(const std::shared_ptr<CallPipeline> &_pipeline);
+            void closeCallPipeline();
+
+            std::shared_ptr<CallPipeline> callPipeline_;
+            «ENDIF»
         };
 
         «fInterface.model.generateNamespaceEndDeclaration»
@@ -218,6 +323,27 @@ class FInterfaceDBusProxyGenerator {
         «generateCommonApiDBusLicenseHeader()»
         «FTypeGenerator::generateComments(fInterface, false)»
         #include <«fInterface.dbusProxyHeaderPath»>
+        «IF fInterface.hasDBusStatistics»
+            #include "«fInterface.dbusStatisticsHeaderPath»"
+        «ENDIF»
+        «IF generateSyncCalls && fInterface.methods.exists[!isFireAndForget && isDBusFixedSize(deploymentAccessor)]»
+
+        #include <cstring>
+        «ENDIF»
+        «IF fInterface.hasDBusPrefetch(deploymentAccessor)»
+
+        #if !defined (COMMONAPI_INTERNAL_COMPILATION)
+        #define COMMONAPI_INTERNAL_COMPILATION
+        #endif
+
+        #include <CommonAPI/DBus/DBusDeployment.hpp>
+        #include <CommonAPI/DBus/DBusInputStream.hpp>
+        #include <CommonAPI/DBus/DBusOutputStream.hpp>
+
+        #undef COMMONAPI_INTERNAL_COMPILATION
+
+        #include <unordered_map>
+        «ENDIF»
 
         «fInterface.generateVersionNamespaceBegin»
         «fInterface.model.generateNamespaceBeginDeclaration»
@@ -229,16 +355,7 @@ class FInterfaceDBusProxyGenerator {
         }
 
         void initialize«fInterface.dbusProxyClassName»() {
-             «FOR p : providers»
-                 «val PropertyAccessor providerAccessor = new PropertyAccessor(new FDeployedProvider(p))»
-                 «FOR i : p.instances.filter[target == fInterface]»
-                     CommonAPI::DBus::DBusAddressTranslator::get()->insert(
-                         "local:«fInterface.fullyQualifiedNameWithVersion»:«providerAccessor.getInstanceId(i)»",
-                         "«providerAccessor.getDBusServiceName(i)»",
-                         "«providerAccessor.getDBusObjectPath(i)»",
-                         "«providerAccessor.getDBusInterfaceName(i)»");
-                 «ENDFOR»
-             «ENDFOR»
+            «fInterface.generateDBusAddressTable(providers)»
              CommonAPI::DBus::Factory::get()->registerProxyCreateMethod(
                 «fInterface.elementName»::getInterface(),
                 &create«fInterface.dbusProxyClassName»);
@@ -276,6 +393,19 @@ class FInterfaceDBusProxyGenerator {
                     «ENDIF»
                 «ENDFOR»
             «ENDFOR»
+            «IF fInterface.hasCallPipeline(deploymentAccessor)»
+                callPipeline_ = std::make_shared<CallPipeline>();
+                callPipeline_->queue_.resize(«deploymentAccessor.getDBusCallQueueSize(fInterface)»);
+            «ENDIF»
+            «IF fInterface.hasDBusPrefetch(deploymentAccessor) && deploymentAccessor.getDBusPrefetchAttributes(fInterface)»
+                isPrefetched_ = false;
+                prefetchStatusSubscription_ = getProxyStatusEvent().subscribe(
+                    [this](const CommonAPI::AvailabilityStatus &_status) {
+                        if (_status != CommonAPI::AvailabilityStatus::AVAILABLE) {
+                            isPrefetched_ = false;
+                        }
+                    });
+            «ENDIF»
         }
 
               «FOR attribute : fInterface.attributes»
@@ -303,7 +433,16 @@ class FInterfaceDBusProxyGenerator {
                 «val outParams = method.generateOutParams(deploymentAccessor, false)»
                 «FTypeGenerator::generateComments(method, false)»
                 «method.generateDefinitionWithin(fInterface.dbusProxyClassName, false)» {
-                    «method.generateProxyHelperDeployments(fInterface, false, deploymentAccessor)»
+                    «IF fInterface.hasDBusStatistics»
+                        «fInterface.dbusStatisticsClassName»::Call itsStatisticsCall(
+                            «fInterface.dbusStatisticsClassName»::getProxyStatistics(), «method.dbusStatisticsIndex», _internalCallStatus);
+                    «ENDIF»
+                    «IF !method.isFireAndForget && errorClasses.empty && method.isDBusFixedSize(deploymentAccessor)»
+                        «method.generateFixedSizeCall(timeout, deploymentAccessor)»
+                    }
+                    «ELSE»
+                    «method.generateProxyHelperDeployments(fInterface, false, false, deploymentAccessor)»
+                    «method.generateSharedBufferCheck(deploymentAccessor, '_internalCallStatus = CommonAPI::CallStatus::OUT_OF_MEMORY;\nreturn;')»
                     «IF method.isFireAndForget»
                         «method.generateDBusProxyHelperClass(fInterface, deploymentAccessor)»::callMethod(
                     «ELSE»
@@ -323,22 +462,116 @@ class FInterfaceDBusProxyGenerator {
             «'std::make_tuple(' + errorClasses.map[it].join(', ') + ')'»«ENDIF»);
             «method.generateOutParamsValue(deploymentAccessor)»
             }
+                    «ENDIF»
             «ENDIF»
             «IF !method.isFireAndForget»
                 «method.generateAsyncDefinitionWithin(fInterface.dbusProxyClassName, false)» {
-                    «method.generateProxyHelperDeployments(fInterface, true, deploymentAccessor)»
+                    «method.generateProxyHelperDeployments(fInterface, true, fInterface.hasCallPipeline(deploymentAccessor), deploymentAccessor)»
+                    «method.generateSharedBufferCheck(deploymentAccessor, 
+                        'if (_callback)\n' +
+                        '    _callback(CommonAPI::CallStatus::OUT_OF_MEMORY' + method.generateRejectedOutValues(fInterface) + ');\n' +
+                        'std::promise<CommonAPI::CallStatus> itsFailure;\n' +
+                        'itsFailure.set_value(CommonAPI::CallStatus::OUT_OF_MEMORY);\n' +
+                        'return itsFailure.get_future();')»
                     «IF timeout != 0»
                         static CommonAPI::CallInfo info(«timeout»);
                     «ENDIF»
+                    «IF fInterface.hasDBusStatistics»
+                        «method.generateStatisticsBegin(fInterface)»
+                    «ENDIF»
+                    «IF fInterface.hasCallPipeline(deploymentAccessor)»
+                    // A queued call starts after the caller returned, so it keeps its own copies.
+                    CommonAPI::CallInfo itsInfo(*(_info ? _info : «IF timeout != 0»&info«ELSE»&CommonAPI::DBus::defaultCallInfo«ENDIF»));
+                    return pipelineCall(
+                        [=](PipelineCompletion_t _completion) mutable {
+                            «method.generateSharedBufferDeployments(deploymentAccessor)»
+                            return «method.generateDBusProxyHelperClass(fInterface, deploymentAccessor)»::callMethodAsync(
+                            *this,
+                            "«method.elementName»",
+                            "«method.dbusInSignature(deploymentAccessor)»",
+                            &itsInfo,
+                            «IF inParams != ""»«inParams»,«ENDIF»
+                            «method.generateCallback(fInterface, deploymentAccessor, "_completion")»«IF !errorClasses.empty»,
+                            «'std::make_tuple(' + errorClasses.map[it].join(', ') + ')'»«ENDIF»);
+                        },
+                        [_callback«method.generateStatisticsCapture(fInterface)»](const CommonAPI::CallStatus &_status) {
+                            «IF fInterface.hasDBusStatistics»
+                                «method.generateStatisticsEnd(fInterface, "_status")»
+                            «ENDIF»
+                            if (_callback)
+                                _callback(_status«method.generateRejectedOutValues(fInterface)»);
+                        });
+                    «ELSE»
                     return «method.generateDBusProxyHelperClass(fInterface, deploymentAccessor)»::callMethodAsync(
                     *this,
                     "«method.elementName»",
                     "«method.dbusInSignature(deploymentAccessor)»",
                     (_info ? _info : «IF timeout != 0»&info«ELSE»&CommonAPI::DBus::defaultCallInfo«ENDIF»),
                     «IF inParams != ""»«inParams»,«ENDIF»
-                    «method.generateCallback(fInterface, deploymentAccessor)»«IF !errorClasses.empty»,
+                    «method.generateCallback(fInterface, deploymentAccessor, "")»«IF !errorClasses.empty»,
                     «'std::make_tuple(' + errorClasses.map[it].join(', ') + ')'»«ENDIF»);
+                    «ENDIF»
+                }
+                «IF fInterface.hasCoroutines»
+
+        #ifdef __cpp_impl_coroutine
+                «fInterface.dbusProxyClassName»::«method.dbusAwaiterClassName» «fInterface.dbusProxyClassName»::«method.elementName»Co(«method.generateAwaiterInParameters»const CommonAPI::CallInfo *_info) {
+                    return «method.dbusAwaiterClassName»(*this, «FOR a : method.inArgs»_«a.name», «ENDFOR»_info);
+                }
+
+                void «fInterface.dbusProxyClassName»::«method.dbusAwaiterClassName»::await_suspend(std::coroutine_handle<> _handle) {
+                    «FOR a : method.inArgs»
+                        const «a.getTypeName(method, true)» &_«a.name» = «a.name»_;
+                    «ENDFOR»
+                    «method.generateProxyHelperDeployments(fInterface, true, fInterface.hasCallPipeline(deploymentAccessor), deploymentAccessor)»
+                    «method.generateSharedBufferCheck(deploymentAccessor, 
+                        'result_ = std::make_tuple(CommonAPI::CallStatus::OUT_OF_MEMORY' + method.generateRejectedOutValues(fInterface) + ');\n' +
+                        '_handle.resume();\n' +
+                        'return;')»
+                    «IF timeout != 0»
+                        static CommonAPI::CallInfo info(«timeout»);
+                    «ENDIF»
+                    «IF fInterface.hasDBusStatistics»
+                        «method.generateStatisticsBegin(fInterface)»
+                    «ENDIF»
+                    // The awaiter lives in the coroutine frame and must not be touched
+                    // once the call is started, the reply may already have resumed it.
+                    «method.dbusAwaiterClassName» *itsAwaiter = this;
+                    «IF fInterface.hasCallPipeline(deploymentAccessor)»
+                    const CommonAPI::CallInfo *itsInfo = (info_ ? info_ : «IF timeout != 0»&info«ELSE»&CommonAPI::DBus::defaultCallInfo«ENDIF»);
+                    «fInterface.dbusProxyClassName» *itsProxy = &proxy_;
+                    itsProxy->pipelineCall(
+                        [=](PipelineCompletion_t _completion) mutable {
+                            «method.generateSharedBufferDeployments(deploymentAccessor)»
+                            return «method.generateDBusProxyHelperClass(fInterface, deploymentAccessor)»::callMethodAsync(
+                            *itsProxy,
+                            "«method.elementName»",
+                            "«method.dbusInSignature(deploymentAccessor)»",
+                            itsInfo,
+                            «IF inParams != ""»«inParams»,«ENDIF»
+                            «method.generateAwaiterCallback(fInterface, deploymentAccessor, "_completion")»«IF !errorClasses.empty»,
+                            «'std::make_tuple(' + errorClasses.map[it].join(', ') + ')'»«ENDIF»);
+                        },
+                        [itsAwaiter, _handle«method.generateStatisticsCapture(fInterface)»](const CommonAPI::CallStatus &_status) {
+                            «IF fInterface.hasDBusStatistics»
+                                «method.generateStatisticsEnd(fInterface, "_status")»
+                            «ENDIF»
+                            itsAwaiter->result_ = std::make_tuple(_status«method.generateRejectedOutValues(fInterface)»);
+                            _handle.resume();
+                        });
+                    «ELSE»
+                    «method.generateDBusProxyHelperClass(fInterface, deploymentAccessor)»::callMethodAsync(
+                    proxy_,
+                    "«method.elementName»",
+                    "«method.dbusInSignature(deploymentAccessor)»",
+                    (info_ ? info_ : «IF timeout != 0»&info«ELSE»&CommonAPI::DBus::defaultCallInfo«ENDIF»),
+                    «IF inParams != ""»«inParams»,«ENDIF»
+                    «method.generateAwaiterCallback(fInterface, deploymentAccessor, "")»«IF !errorClasses.empty»,
+                    «'std::make_tuple(' + errorClasses.map[it].join(', ') + ')'»«ENDIF»);
+                    «ENDIF»
                 }
+        #endif
+                «ENDIF»
             «ENDIF»
               «ENDFOR»
 
@@ -358,6 +591,14 @@ class FInterfaceDBusProxyGenerator {
                       ownVersionMinor = 0;
                   «ENDIF»
               }
+        «IF fInterface.hasDBusPrefetch(deploymentAccessor)»
+
+            «fInterface.generatePrefetchAttributesDefinition(deploymentAccessor)»
+        «ENDIF»
+        «IF fInterface.hasCallPipeline(deploymentAccessor)»
+
+            «fInterface.generateCallPipelineDefinitions(deploymentAccessor)»
+        «ENDIF»
 
               «fInterface.model.generateNamespaceEndDeclaration»
               «fInterface.generateVersionNamespaceEnd»
@@ -394,14 +635,6 @@ class FInterfaceDBusProxyGenerator {
         fInterface.versionPathPrefix + fInterface.model.directoryPath + '/' + fInterface.dbusProxyHeaderFile
     }
 
-    def private dbusProxySourceFile(FInterface fInterface) {
-        fInterface.elementName + "DBusProxy.cpp"
-    }
-
-    def private dbusProxySourcePath(FInterface fInterface) {
-        fInterface.versionPathPrefix + fInterface.model.directoryPath + '/' + fInterface.dbusProxySourceFile
-    }
-
     def private dbusProxyClassName(FInterface fInterface) {
         fInterface.elementName + 'DBusProxy'
     }
@@ -417,7 +650,11 @@ class FInterfaceDBusProxyGenerator {
     CommonAPI::DBus::DBusProxyHelper<
         CommonAPI::DBus::DBusSerializableArguments<
         «FOR a : fMethod.inArgs»
-            CommonAPI::Deployable< «a.getTypeName(fMethod, true)», «a.getDeploymentType(_interface, true)» >«IF a != fMethod.inArgs.last»,«ENDIF»
+            «IF a.isDBusSharedBuffer(_accessor)»
+                CommonAPI::Deployable< uint32_t, CommonAPI::DBus::IntegerDeployment >«IF a != fMethod.inArgs.last»,«ENDIF»
+            «ELSE»
+                CommonAPI::Deployable< «a.getTypeName(fMethod, true)», «a.getDeploymentType(_interface, true)» >«IF a != fMethod.inArgs.last»,«ENDIF»
+            «ENDIF»
         «ENDFOR»
         >,
         CommonAPI::DBus::DBusSerializableArguments<
@@ -455,6 +692,403 @@ class FInterfaceDBusProxyGenerator {
         return type
     }
 
+    def private boolean isDBusCached(FAttribute fAttribute, PropertyAccessor deploymentAccessor) {
+        return fAttribute.isObservable && deploymentAccessor.getDBusAttributeCaching(fAttribute)
+    }
+
+    def private dbusAttributeMemberClassName(FAttribute fAttribute, PropertyAccessor deploymentAccessor, FInterface fInterface) {
+        if (fAttribute.isDBusCached(deploymentAccessor))
+            return 'DBus' + fAttribute.dbusClassVariableName + 'CachedAttribute'
+        if (fAttribute.supportsTypeValidation)
+            return 'DBus' + fAttribute.dbusClassVariableName + 'Attribute'
+        return fAttribute.dbusClassName(deploymentAccessor, fInterface)
+    }
+
+    // Reads are served from a local copy while the proxy listens to the change
+    // notifications of the attribute. The first read subscribes; a successful read
+    // is only kept if no notification arrived in the meantime (cacheGeneration_).
+    def private generateCachedAttributeClass(FAttribute fAttribute, PropertyAccessor deploymentAccessor, FInterface fInterface) '''
+        «val String baseClassName = if (fAttribute.supportsTypeValidation) 'DBus' + fAttribute.dbusClassVariableName + 'Attribute' else fAttribute.dbusClassName(deploymentAccessor, fInterface)»
+        «val String className = 'DBus' + fAttribute.dbusClassVariableName + 'CachedAttribute'»
+        «val String valueType = fAttribute.getTypeName(fInterface, true)»
+        class «className» : public «baseClassName» {
+        public:
+            template <typename... _A>
+            «className»(DBusProxy &_proxy,
+                _A ... arguments)
+                : «baseClassName»(
+                    _proxy, arguments...),
+                  cacheProxy_(_proxy) {}
+
+            virtual ~«className»() {
+                bool isSubscribed(false);
+                CommonAPI::ProxyStatusEvent::Subscription itsStatusSubscription;
+                CommonAPI::Event<«valueType»>::Subscription itsChangedSubscription;
+                {
+                    std::lock_guard<std::mutex> itsLock(cacheMutex_);
+                    isSubscribed = isCacheSubscribed_;
+                    itsStatusSubscription = statusSubscription_;
+                    itsChangedSubscription = changedSubscription_;
+                }
+                if (isSubscribed) {
+                    cacheProxy_.getProxyStatusEvent().unsubscribe(itsStatusSubscription);
+                    this->getChangedEvent().unsubscribe(itsChangedSubscription);
+                }
+            }
+
+            void getValue(CommonAPI::CallStatus &_status,
+                «valueType» &_value,
+                const CommonAPI::CallInfo *_info = nullptr) const {
+                uint32_t itsGeneration(0);
+                {
+                    std::lock_guard<std::mutex> itsLock(cacheMutex_);
+                    if (isCached_) {
+                        _value = cachedValue_;
+                        _status = CommonAPI::CallStatus::SUCCESS;
+                        return;
+                    }
+                    itsGeneration = cacheGeneration_;
+                }
+                subscribeCache();
+                «baseClassName»::getValue(_status, _value, _info);
+                if (_status == CommonAPI::CallStatus::SUCCESS) {
+                    updateCache(_value, itsGeneration);
+                }
+            }
+
+            std::future<CommonAPI::CallStatus> getValueAsync(
+                std::function<void(const CommonAPI::CallStatus &, «valueType»)> _callback,
+                const CommonAPI::CallInfo *_info = nullptr) {
+                «valueType» itsValue;
+                bool isCached(false);
+                {
+                    std::lock_guard<std::mutex> itsLock(cacheMutex_);
+                    if (isCached_) {
+                        itsValue = cachedValue_;
+                        isCached = true;
+                    }
+                }
+                if (isCached) {
+                    _callback(CommonAPI::CallStatus::SUCCESS, itsValue);
+                    std::promise<CommonAPI::CallStatus> promise;
+                    promise.set_value(CommonAPI::CallStatus::SUCCESS);
+                    return promise.get_future();
+                }
+                subscribeCache();
+                return «baseClassName»::getValueAsync(_callback, _info);
+            }
+            «IF deploymentAccessor.getPropertiesType(fInterface) == PropertyAccessor.PropertiesType.freedesktop»
+
+                // Starts listening and returns the generation a value read afterwards
+                // has to be seeded with.
+                uint32_t prepareCache() const {
+                    subscribeCache();
+                    std::lock_guard<std::mutex> itsLock(cacheMutex_);
+                    return cacheGeneration_;
+                }
+
+                // The change notifications were requested before the value was read, so
+                // the value is kept unless a notification arrived in the meantime.
+                void seedCache(const «valueType» &_value, uint32_t _generation) const {
+                    std::lock_guard<std::mutex> itsLock(cacheMutex_);
+                    if (isCacheSubscribed_ && _generation == cacheGeneration_) {
+                        cachedValue_ = _value;
+                        isCached_ = true;
+                    }
+                }
+            «ENDIF»
+            «IF !fAttribute.isReadonly»
+
+                void setValue(const «valueType» &requestValue,
+                    CommonAPI::CallStatus &callStatus,
+                    «valueType» &responseValue,
+                    const CommonAPI::CallInfo *_info = nullptr) {
+                    «baseClassName»::setValue(requestValue, callStatus, responseValue, _info);
+                    invalidateCache();
+                }
+
+                std::future<CommonAPI::CallStatus> setValueAsync(const «valueType» &requestValue,
+                    std::function<void(const CommonAPI::CallStatus &, «valueType»)> _callback,
+                    const CommonAPI::CallInfo *_info = nullptr) {
+                    return «baseClassName»::setValueAsync(requestValue,
+                        [this, _callback](const CommonAPI::CallStatus &_status, «valueType» _value) {
+                            invalidateCache();
+                            _callback(_status, _value);
+                        }, _info);
+                }
+            «ENDIF»
+
+        private:
+            void subscribeCache() const {
+                {
+                    std::lock_guard<std::mutex> itsLock(cacheMutex_);
+                    if (isCacheSubscribed_) {
+                        return;
+                    }
+                    isCacheSubscribed_ = true;
+                }
+                // The callbacks may run before subscribe() returns and take the lock,
+                // so it is only held to store the subscriptions.
+                CommonAPI::ProxyStatusEvent::Subscription itsStatusSubscription
+                    = cacheProxy_.getProxyStatusEvent().subscribe(
+                        [this](const CommonAPI::AvailabilityStatus &_status) {
+                            if (_status != CommonAPI::AvailabilityStatus::AVAILABLE) {
+                                invalidateCache();
+                            }
+                        });
+                CommonAPI::Event<«valueType»>::Subscription itsChangedSubscription
+                    = const_cast<«className» *>(this)->getChangedEvent().subscribe(
+                        [this](const «valueType» &_value) {
+                            std::lock_guard<std::mutex> itsLock(cacheMutex_);
+                            cachedValue_ = _value;
+                            isCached_ = true;
+                            isCacheListening_ = true;
+                            cacheGeneration_++;
+                        });
+                std::lock_guard<std::mutex> itsLock(cacheMutex_);
+                statusSubscription_ = itsStatusSubscription;
+                changedSubscription_ = itsChangedSubscription;
+            }
+
+            void updateCache(const «valueType» &_value, uint32_t _generation) const {
+                std::lock_guard<std::mutex> itsLock(cacheMutex_);
+                if (isCacheListening_ && _generation == cacheGeneration_) {
+                    cachedValue_ = _value;
+                    isCached_ = true;
+                }
+            }
+
+            void invalidateCache() const {
+                std::lock_guard<std::mutex> itsLock(cacheMutex_);
+                isCached_ = false;
+                cacheGeneration_++;
+            }
+
+            DBusProxy &cacheProxy_;
+            mutable std::mutex cacheMutex_;
+            mutable «valueType» cachedValue_;
+            mutable bool isCached_ = false;
+            mutable bool isCacheListening_ = false;
+            mutable bool isCacheSubscribed_ = false;
+            mutable uint32_t cacheGeneration_ = 0;
+            mutable CommonAPI::ProxyStatusEvent::Subscription statusSubscription_;
+            mutable CommonAPI::Event<«valueType»>::Subscription changedSubscription_;
+        };
+    '''
+
+    // Prefetching uses the freedesktop Properties interface and only pays off
+    // for attributes that keep a local copy.
+    def private boolean hasDBusPrefetch(FInterface fInterface, PropertyAccessor deploymentAccessor) {
+        return deploymentAccessor.getPropertiesType(fInterface) == PropertyAccessor.PropertiesType.freedesktop
+            && fInterface.attributes.exists[isDBusCached(deploymentAccessor)]
+    }
+
+    // GetAll returns the inherited properties as well, so the variant needs one
+    // alternative per distinct C++ type of the whole hierarchy. Inherited attributes
+    // are read with their default deployment.
+    def private getPrefetchedPropertyTypes(FInterface fInterface, PropertyAccessor deploymentAccessor) {
+        val types = new LinkedHashMap<String, Pair<String, String>>()
+        for (attribute : fInterface.attributes) {
+            val typeName = attribute.getTypeName(fInterface, true)
+            if (!types.containsKey(typeName)) {
+                types.put(typeName, attribute.getDeploymentType(fInterface, true)
+                    -> attribute.getDeploymentRef(attribute.array, null, fInterface, deploymentAccessor))
+            }
+        }
+        var FInterface base = fInterface.base
+        while (base != null) {
+            for (attribute : base.attributes) {
+                val typeName = attribute.getTypeName(fInterface, true)
+                if (!types.containsKey(typeName)) {
+                    val deploymentType = attribute.getDeploymentType(fInterface, true)
+                    types.put(typeName, deploymentType -> "static_cast< " + deploymentType + "* >(nullptr)")
+                }
+            }
+            base = base.base
+        }
+        return types
+    }
+
+    def private generatePrefetchAttributesDefinition(FInterface fInterface, PropertyAccessor deploymentAccessor) '''
+        «val types = fInterface.getPrefetchedPropertyTypes(deploymentAccessor)»
+        «val cachedAttributes = fInterface.attributes.filter[isDBusCached(deploymentAccessor)
+            && types.get(getTypeName(fInterface, true)).value == getDeploymentRef(array, null, fInterface, deploymentAccessor)]»
+        void «fInterface.dbusProxyClassName»::prefetchAttributes(CommonAPI::CallStatus &_status, const CommonAPI::CallInfo *_info) {
+            if (!CommonAPI::DBus::DBusProxy::isAvailable()) {
+                _status = CommonAPI::CallStatus::NOT_AVAILABLE;
+                return;
+            }
+
+            «FOR attribute : cachedAttributes»
+                const uint32_t «attribute.elementName.toFirstLower»Generation = «attribute.dbusClassVariableName».prepareCache();
+            «ENDFOR»
+
+            CommonAPI::DBus::DBusAddress itsAddress(getDBusAddress().getService(), getDBusAddress().getObjectPath(), "org.freedesktop.DBus.Properties");
+            CommonAPI::DBus::DBusMessage methodCall = CommonAPI::DBus::DBusMessage::createMethodCall(itsAddress, "GetAll", "s");
+            CommonAPI::DBus::DBusOutputStream output(methodCall);
+            output.writeValue(getDBusAddress().getInterface(), static_cast<CommonAPI::EmptyDeployment *>(nullptr));
+            output.flush();
+
+            CommonAPI::DBus::DBusError error;
+            CommonAPI::DBus::DBusMessage reply = getDBusConnection()->sendDBusMessageWithReplyAndBlock(
+                methodCall, error, (_info ? _info : &CommonAPI::DBus::defaultCallInfo));
+            if (error || !reply.isMethodReturnType()) {
+                _status = CommonAPI::CallStatus::REMOTE_ERROR;
+                return;
+            }
+
+            typedef CommonAPI::Variant<
+                «types.keySet.join(',
+')»
+            > PropertyValue_t;
+            typedef CommonAPI::DBus::VariantDeployment<
+                «types.values.map[key].join(',
+')»
+            > PropertyValueDeployment_t;
+            PropertyValueDeployment_t itsValueDeployment(true,
+                «types.values.map[value].join(',
+')»);
+            CommonAPI::MapDeployment<CommonAPI::EmptyDeployment, PropertyValueDeployment_t> itsDeployment(nullptr, &itsValueDeployment);
+
+            std::unordered_map<std::string, PropertyValue_t> itsProperties;
+            CommonAPI::DBus::DBusInputStream input(reply);
+            input.readValue(itsProperties, &itsDeployment);
+            if (input.hasError()) {
+                _status = CommonAPI::CallStatus::REMOTE_ERROR;
+                return;
+            }
+
+            «FOR attribute : cachedAttributes»
+                {
+                    auto itsProperty = itsProperties.find("«attribute.elementName»");
+                    if (itsProperty != itsProperties.end() && itsProperty->second.isType< «attribute.getTypeName(fInterface, true)» >()) {
+                        «attribute.dbusClassVariableName».seedCache(itsProperty->second.get< «attribute.getTypeName(fInterface, true)» >(), «attribute.elementName.toFirstLower»Generation);
+                    }
+                }
+            «ENDFOR»
+            _status = CommonAPI::CallStatus::SUCCESS;
+        }
+        «IF deploymentAccessor.getDBusPrefetchAttributes(fInterface)»
+
+            bool «fInterface.dbusProxyClassName»::isAvailableBlocking() const {
+                if (!CommonAPI::DBus::DBusProxy::isAvailableBlocking()) {
+                    return false;
+                }
+                // A failed prefetch is not retried, the attributes are then read one by one.
+                if (!isPrefetched_.exchange(true)) {
+                    CommonAPI::CallStatus itsStatus;
+                    const_cast<«fInterface.dbusProxyClassName» *>(this)->prefetchAttributes(itsStatus);
+                }
+                return true;
+            }
+        «ENDIF»
+    '''
+
+    def private boolean hasCallPipeline(FInterface fInterface, PropertyAccessor deploymentAccessor) {
+        return deploymentAccessor.getDBusMaxInFlightCalls(fInterface) > 0
+            && fInterface.methods.exists[!isFireAndForget]
+    }
+
+    // At most DBusMaxInFlightCalls asynchronous calls are pending at the connection.
+    // Further calls wait in a fixed size ring and are started from the reply
+    // callback of the call they are waiting for.
+    def private generateCallPipelineDefinitions(FInterface fInterface, PropertyAccessor deploymentAccessor) '''
+        std::future<CommonAPI::CallStatus> «fInterface.dbusProxyClassName»::pipelineCall(PipelineStart_t _start, PipelineCompletion_t _reject) {
+            std::shared_ptr<CallPipeline> itsPipeline(callPipeline_);
+            {
+                std::lock_guard<std::mutex> itsLock(itsPipeline->mutex_);
+                if (itsPipeline->inFlight_ < «deploymentAccessor.getDBusMaxInFlightCalls(fInterface)») {
+                    itsPipeline->inFlight_++;
+                } else if (itsPipeline->queued_ < itsPipeline->queue_.size()) {
+                    PipelinedCall &itsCall = itsPipeline->queue_[(itsPipeline->head_ + itsPipeline->queued_) % itsPipeline->queue_.size()];
+                    itsCall.start_ = _start;
+                    itsCall.reject_ = _reject;
+                    itsCall.promise_ = std::make_shared<std::promise<CommonAPI::CallStatus>>();
+                    itsPipeline->queued_++;
+                    return itsCall.promise_->get_future();
+                } else {
+                    itsPipeline->rejected_++;
+                    itsPipeline.reset();
+                }
+            }
+            if (!itsPipeline) {
+                _reject(CommonAPI::CallStatus::OUT_OF_MEMORY);
+                std::promise<CommonAPI::CallStatus> promise;
+                promise.set_value(CommonAPI::CallStatus::OUT_OF_MEMORY);
+                return promise.get_future();
+            }
+            return _start([itsPipeline](const CommonAPI::CallStatus &) {
+                completePipelinedCall(itsPipeline);
+            });
+        }
+
+        void «fInterface.dbusProxyClassName»::completePipelinedCall(const std::shared_ptr<CallPipeline> &_pipeline) {
+            PipelinedCall itsNext;
+            {
+                std::lock_guard<std::mutex> itsLock(_pipeline->mutex_);
+                if (_pipeline->queued_ == 0 || _pipeline->isClosed_) {
+                    _pipeline->inFlight_--;
+                    return;
+                }
+                // The slot of the completed call is handed over to the next one.
+                std::swap(itsNext, _pipeline->queue_[_pipeline->head_]);
+                _pipeline->head_ = (_pipeline->head_ + 1) % _pipeline->queue_.size();
+                _pipeline->queued_--;
+                // The start refers to the proxy, closeCallPipeline() waits for it.
+                _pipeline->starting_.push_back(std::this_thread::get_id());
+            }
+            std::shared_ptr<CallPipeline> itsPipeline(_pipeline);
+            std::shared_ptr<std::promise<CommonAPI::CallStatus>> itsPromise(itsNext.promise_);
+            itsNext.start_([itsPipeline, itsPromise](const CommonAPI::CallStatus &_status) {
+                itsPromise->set_value(_status);
+                completePipelinedCall(itsPipeline);
+            });
+            {
+                std::lock_guard<std::mutex> itsLock(_pipeline->mutex_);
+                _pipeline->starting_.erase(
+                    std::find(_pipeline->starting_.begin(), _pipeline->starting_.end(), std::this_thread::get_id()));
+            }
+            _pipeline->startDone_.notify_all();
+        }
+
+        void «fInterface.dbusProxyClassName»::closeCallPipeline() {
+            std::vector<PipelinedCall> itsQueued;
+            {
+                std::unique_lock<std::mutex> itsLock(callPipeline_->mutex_);
+                callPipeline_->isClosed_ = true;
+                for (; callPipeline_->queued_ > 0; callPipeline_->queued_--) {
+                    itsQueued.push_back(PipelinedCall());
+                    std::swap(itsQueued.back(), callPipeline_->queue_[callPipeline_->head_]);
+                    callPipeline_->head_ = (callPipeline_->head_ + 1) % callPipeline_->queue_.size();
+                }
+                // No call is started once the pipeline is closed. Starts already running on
+                // other threads still use the proxy, so it must outlive them. A start on this
+                // thread is the caller itself (the proxy was released from a reply callback
+                // invoked by the start) and does not touch the proxy after that callback.
+                const std::thread::id itsThread = std::this_thread::get_id();
+                std::vector<std::thread::id> &itsStarting = callPipeline_->starting_;
+                callPipeline_->startDone_.wait(itsLock, [&itsStarting, itsThread]() {
+                    return std::all_of(itsStarting.begin(), itsStarting.end(),
+                        [itsThread](const std::thread::id &_id) { return _id == itsThread; });
+                });
+            }
+            for (auto &itsCall : itsQueued) {
+                itsCall.reject_(CommonAPI::CallStatus::NOT_AVAILABLE);
+                itsCall.promise_->set_value(CommonAPI::CallStatus::NOT_AVAILABLE);
+            }
+        }
+
+        std::size_t «fInterface.dbusProxyClassName»::getQueuedCallCount() const {
+            std::lock_guard<std::mutex> itsLock(callPipeline_->mutex_);
+            return callPipeline_->queued_;
+        }
+
+        uint64_t «fInterface.dbusProxyClassName»::getRejectedCallCount() const {
+            std::lock_guard<std::mutex> itsLock(callPipeline_->mutex_);
+            return callPipeline_->rejected_;
+        }
+    '''
+
     def private generateDBusVariableInit(FAttribute fAttribute, PropertyAccessor deploymentAccessor,
         FInterface fInterface) {
         var ret = fAttribute.dbusClassVariableName + '(*this'
@@ -512,16 +1146,83 @@ class FInterfaceDBusProxyGenerator {
         return ret + '>'
     }
 
+    /**
+     * Synchronous call of a method that only has fixed size arguments. The arguments
+     * are copied to and from the message bodies at offsets computed here, fixed size
+     * structs through the «Struct»Layout_t of their deployment; neither argument
+     * tuples nor stream buffers are needed.
+     */
+    def private generateFixedSizeCall(FMethod _method, int _timeout, PropertyAccessor _accessor) '''
+        «val inOffsets = _method.inArgs.dbusFixedSizeOffsets(_accessor)»
+        «val outOffsets = _method.outArgs.dbusFixedSizeOffsets(_accessor)»
+        «IF _timeout != 0»
+            static CommonAPI::CallInfo info(«_timeout»);
+        «ENDIF»
+        if (!isAvailableBlocking()) {
+            _internalCallStatus = CommonAPI::CallStatus::NOT_AVAILABLE;
+            return;
+        }
+        CommonAPI::DBus::DBusMessage methodCall = createMethodCall("«_method.elementName»", "«_method.dbusInSignature(_accessor)»");
+        «IF !_method.inArgs.empty»
+            if (!methodCall.setBodyLength(«inOffsets.last»)) {
+                _internalCallStatus = CommonAPI::CallStatus::OUT_OF_MEMORY;
+                return;
+            }
+            char *body = methodCall.getBodyData();
+            std::memset(body, 0, «inOffsets.last»);
+            «FOR i : 0 ..< _method.inArgs.size»
+                «val a = _method.inArgs.get(i)»
+                «val signature = a.getTypeDbusSignature(_accessor)»
+                «IF a.dbusFixedSizeStruct(_accessor) != null»
+                    «a.dbusFixedSizeStruct(_accessor).dbusLayoutName»::write(body + «inOffsets.get(i)», _«a.name»);
+                «ELSE»
+                    const «signature.dbusFixedSizeWireType» wire_«a.name» = static_cast< «signature.dbusFixedSizeWireType» >(_«a.name»);
+                    std::memcpy(body + «inOffsets.get(i)», &wire_«a.name», «signature.dbusFixedSize»);
+                «ENDIF»
+            «ENDFOR»
+        «ENDIF»
+        CommonAPI::DBus::DBusError error;
+        CommonAPI::DBus::DBusMessage reply = getDBusConnection()->sendDBusMessageWithReplyAndBlock(
+            methodCall, error, (_info ? _info : «IF _timeout != 0»&info«ELSE»&CommonAPI::DBus::defaultCallInfo«ENDIF»));
+        if (error || !reply.isMethodReturnType()«IF outOffsets.last > 0» || reply.getBodyLength() < «outOffsets.last»«ENDIF»
+                || std::strcmp(reply.getSignature(), "«_method.dbusOutSignature(_accessor)»") != 0) {
+            _internalCallStatus = CommonAPI::CallStatus::REMOTE_ERROR;
+            return;
+        }
+        «IF !_method.outArgs.empty»
+            const char *replyBody = reply.getBodyData();
+            «FOR i : 0 ..< _method.outArgs.size»
+                «val a = _method.outArgs.get(i)»
+                «val signature = a.getTypeDbusSignature(_accessor)»
+                «IF a.dbusFixedSizeStruct(_accessor) != null»
+                    «a.dbusFixedSizeStruct(_accessor).dbusLayoutName»::read(replyBody + «outOffsets.get(i)», _«a.name»);
+                «ELSE»
+                    «signature.dbusFixedSizeWireType» wire_«a.name»;
+                    std::memcpy(&wire_«a.name», replyBody + «outOffsets.get(i)», «signature.dbusFixedSize»);
+                    _«a.name» = static_cast< «a.getTypeName(_method, true)» >(wire_«a.name»);
+                «ENDIF»
+            «ENDFOR»
+        «ENDIF»
+        _internalCallStatus = CommonAPI::CallStatus::SUCCESS;
+    '''
+
     def private generateProxyHelperDeployments(FMethod _method,
-        FInterface _interface, boolean _isAsync,
+        FInterface _interface, boolean _isAsync, boolean _isDeferred,
         PropertyAccessor _accessor) '''
         «IF _method.hasError»
             CommonAPI::Deployable< «_method.errorType», «_method.getErrorDeploymentType(false)»> deploy_error(«_method.
             getErrorDeploymentRef(_interface, _accessor)»);
         «ENDIF»
         «FOR a : _method.inArgs»
-            CommonAPI::Deployable< «a.getTypeName(_method, true)», «a.getDeploymentType(_interface, true)»> deploy_«a.name»(_«a.
-            name», «a.getDeploymentRef(a.array, _method, _interface, _accessor)»);
+            «IF a.isDBusSharedBuffer(_accessor)»
+                ::commonapi::dbus::SharedBuffer shared_«a.name»(_«a.name»);
+                «IF !_isDeferred»
+                    CommonAPI::Deployable< uint32_t, CommonAPI::DBus::IntegerDeployment > deploy_«a.name»(shared_«a.name».getFd(), &«_interface.getFullName»_::sharedBufferDeployment);
+                «ENDIF»
+            «ELSE»
+                CommonAPI::Deployable< «a.getTypeName(_method, true)», «a.getDeploymentType(_interface, true)»> deploy_«a.name»(_«a.
+                name», «a.getDeploymentRef(a.array, _method, _interface, _accessor)»);
+            «ENDIF»
         «ENDFOR»
         «FOR a : _method.outArgs»
             CommonAPI::Deployable< «a.getTypeName(_method, true)», «a.getDeploymentType(_interface, true)»> deploy_«a.name»(«a.
@@ -529,6 +1230,25 @@ class FInterfaceDBusProxyGenerator {
         «ENDFOR»
     '''
 
+    /**
+     * Deployments of the shared buffers of a call that is started later. They refer to the
+     * memfd copies made by the caller, which stay open as long as the call captures them.
+     */
+    def private generateSharedBufferDeployments(FMethod _method, PropertyAccessor _accessor) '''
+        «val FInterface itsInterface = _method.eContainer as FInterface»
+        «FOR a : _method.inArgs.filter[isDBusSharedBuffer(_accessor)]»
+            CommonAPI::Deployable< uint32_t, CommonAPI::DBus::IntegerDeployment > deploy_«a.name»(shared_«a.name».getFd(), &«itsInterface.getFullName»_::sharedBufferDeployment);
+        «ENDFOR»
+    '''
+
+    def private generateSharedBufferCheck(FMethod _method, PropertyAccessor _accessor, String _failure) '''
+        «IF _method.hasDBusSharedBuffers(_accessor)»
+            if («_method.inArgs.filter[isDBusSharedBuffer(_accessor)].map['!shared_' + name].join(' || ')») {
+                «_failure»
+            }
+        «ENDIF»
+    '''
+
     def private generateInParams(FMethod _method, PropertyAccessor _accessor) {
         var String inParams = ""
         for (a : _method.inArgs) {
@@ -561,14 +1281,16 @@ class FInterfaceDBusProxyGenerator {
     }
 
     def private generateCallback(FMethod _method, FInterface _interface,
-        PropertyAccessor _accessor) {
+        PropertyAccessor _accessor, String _completion) {
 
         var String error = ""
         if (_method.hasError) {
             error = "deploy_error"
         }
 
-        var String callback = "[_callback] (" + generateCallbackParameter(_method, _interface, _accessor) + ") {\n"
+        var String callback = "[_callback" + (if (_completion != "") ", " + _completion else "") + _method.generateStatisticsCapture(_interface) + "] (" + generateCallbackParameter(_method, _interface, _accessor) + ") {\n"
+        if (_interface.hasDBusStatistics)
+            callback += "    " + _method.generateStatisticsEnd(_interface, "_internalCallStatus") + "\n"
         callback += "    if (_callback)\n"
         callback += "        _callback(_internalCallStatus"
         if(_method.hasError) callback += ", _deploy_error.getValue()"
@@ -577,6 +1299,8 @@ class FInterfaceDBusProxyGenerator {
             callback += ".getValue()"
         }
         callback += ");\n"
+        if (_completion != "")
+            callback += "    " + _completion + "(_internalCallStatus);\n"
         callback += "},\n"
 
         var String out = generateOutParams(_method, _accessor, true)
@@ -585,6 +1309,120 @@ class FInterfaceDBusProxyGenerator {
         return callback
     }
 
+    def private boolean hasCoroutines(FInterface fInterface) {
+        return generateCoroutines && fInterface.methods.exists[!isFireAndForget]
+    }
+
+    // Overloaded methods share their name, their awaiters are numbered.
+    def private dbusAwaiterClassName(FMethod fMethod) {
+        val FInterface fInterface = fMethod.eContainer as FInterface
+        val overloads = fInterface.methods.filter[elementName == fMethod.elementName].toList
+        if (overloads.size > 1)
+            return fMethod.elementName.toFirstUpper + 'Awaiter' + overloads.indexOf(fMethod)
+        return fMethod.elementName.toFirstUpper + 'Awaiter'
+    }
+
+    def private generateAwaiterInParameters(FMethod fMethod) {
+        var String parameters = ""
+        for (a : fMethod.inArgs) {
+            parameters += "const " + a.getTypeName(fMethod, true) + " &_" + a.name + ", "
+        }
+        return parameters
+    }
+
+    def private generateAwaiterResultType(FMethod fMethod) {
+        var String type = "std::tuple<CommonAPI::CallStatus"
+        if (fMethod.hasError)
+            type += ", " + fMethod.errorType
+        for (a : fMethod.outArgs) {
+            type += ", " + a.getTypeName(fMethod, true)
+        }
+        return type + ">"
+    }
+
+    // The in arguments are referenced, not copied: like any awaitable taking
+    // references, the call has to be awaited in the expression that creates it.
+    def private generateAwaiterClass(FMethod fMethod, FInterface fInterface) '''
+        class «fMethod.dbusAwaiterClassName» {
+        public:
+            «fMethod.dbusAwaiterClassName»(«fInterface.dbusProxyClassName» &_proxy, «fMethod.generateAwaiterInParameters»const CommonAPI::CallInfo *_info)
+                : proxy_(_proxy),«FOR a : fMethod.inArgs» «a.name»_(_«a.name»),«ENDFOR» info_(_info) {}
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> _handle);
+            «fMethod.generateAwaiterResultType» await_resume() { return std::move(result_); }
+
+        private:
+            «fInterface.dbusProxyClassName» &proxy_;
+            «FOR a : fMethod.inArgs»
+                const «a.getTypeName(fMethod, true)» &«a.name»_;
+            «ENDFOR»
+            const CommonAPI::CallInfo *info_;
+            «fMethod.generateAwaiterResultType» result_;
+        };
+    '''
+
+    // Captures only the awaiter and the coroutine handle, which fits into the
+    // small buffer of std::function (unless the start of the call is captured
+    // for the statistics).
+    def private generateAwaiterCallback(FMethod _method, FInterface _interface,
+        PropertyAccessor _accessor, String _completion) {
+
+        var String callback = "[itsAwaiter, _handle" + (if (_completion != "") ", " + _completion else "") + _method.generateStatisticsCapture(_interface) + "] (" + generateCallbackParameter(_method, _interface, _accessor) + ") {\n"
+        if (_interface.hasDBusStatistics)
+            callback += "    " + _method.generateStatisticsEnd(_interface, "_internalCallStatus") + "\n"
+        callback += "    itsAwaiter->result_ = std::make_tuple(_internalCallStatus"
+        if(_method.hasError) callback += ", _deploy_error.getValue()"
+        for (a : _method.outArgs) {
+            callback += ", _" + a.name + ".getValue()"
+        }
+        callback += ");\n"
+        if (_completion != "")
+            callback += "    " + _completion + "(_internalCallStatus);\n"
+        callback += "    _handle.resume();\n"
+        callback += "},\n"
+
+        var String error = ""
+        if (_method.hasError) {
+            error = "deploy_error"
+        }
+        var String out = generateOutParams(_method, _accessor, true)
+        if(error != "" && out != "") error += ", "
+        callback += "std::make_tuple(" + error + out + ")"
+        return callback
+    }
+
+    // An asynchronous call is counted from its start until its callback or its rejection.
+    def private generateStatisticsBegin(FMethod _method, FInterface _interface) {
+        if (!_interface.hasDBusStatistics)
+            return ""
+        return "const std::chrono::steady_clock::time_point itsStatisticsStart = " +
+            _interface.dbusStatisticsClassName + "::getProxyStatistics().begin(" + _method.dbusStatisticsIndex + ");"
+    }
+
+    def private generateStatisticsCapture(FMethod _method, FInterface _interface) {
+        if (!_interface.hasDBusStatistics)
+            return ""
+        return ", itsStatisticsStart"
+    }
+
+    def private generateStatisticsEnd(FMethod _method, FInterface _interface, String _status) {
+        if (!_interface.hasDBusStatistics)
+            return ""
+        return _interface.dbusStatisticsClassName + "::getProxyStatistics().end(" + _method.dbusStatisticsIndex +
+            ", itsStatisticsStart, " + _status + " != CommonAPI::CallStatus::SUCCESS);"
+    }
+
+    def private generateRejectedOutValues(FMethod _method, FInterface _interface) {
+        var String values = ""
+        if (_method.hasError)
+            values += ", " + _method.errorType + "()"
+        for (a : _method.outArgs) {
+            values += ", " + a.getTypeName(_method, true) + "()"
+        }
+        return values
+    }
+
     def private generateCallbackParameter(FMethod _method,
         FInterface _interface, PropertyAccessor _accessor) {
         var String declaration = "CommonAPI::CallStatus _internalCallStatus"
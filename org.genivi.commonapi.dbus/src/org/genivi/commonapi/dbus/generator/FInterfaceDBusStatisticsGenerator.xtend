@@ -0,0 +1,232 @@
+/* Copyright (C) 2015 BMW Group
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+package org.genivi.commonapi.dbus.generator
+
+import javax.inject.Inject
+import org.eclipse.core.resources.IResource
+import org.eclipse.xtext.generator.IFileSystemAccess
+import org.franca.core.franca.FInterface
+import org.genivi.commonapi.core.generator.FrancaGeneratorExtensions
+import org.genivi.commonapi.dbus.deployment.PropertyAccessor
+import org.genivi.commonapi.dbus.preferences.FPreferencesDBus
+import org.genivi.commonapi.dbus.preferences.PreferenceConstantsDBus
+
+/**
+ * Generates the per-method call statistics that the proxy and the stub adapter
+ * of an interface record into if P_GENERATE_STATISTICS_DBUS or
+ * P_GENERATE_STATISTICS_INTERFACE_DBUS is set.
+ */
+class FInterfaceDBusStatisticsGenerator {
+    @Inject private extension FrancaGeneratorExtensions
+    @Inject private extension FrancaDBusGeneratorExtensions
+
+    def generateStatistics(FInterface fInterface, IFileSystemAccess fileSystemAccess,
+        PropertyAccessor deploymentAccessor, IResource modelid) {
+
+        if (!fInterface.hasDBusStatistics) {
+            return
+        }
+        if(FPreferencesDBus::getInstance.getPreference(PreferenceConstantsDBus::P_GENERATE_CODE_DBUS, "true").equals("true")) {
+            fileSystemAccess.generateFile(fInterface.dbusStatisticsHeaderPath, IFileSystemAccess.DEFAULT_OUTPUT,
+                fInterface.generateStatisticsHeader(deploymentAccessor, modelid))
+        }
+        else {
+            // feature: suppress code generation
+            fileSystemAccess.generateFile(fInterface.dbusStatisticsHeaderPath, IFileSystemAccess.DEFAULT_OUTPUT, PreferenceConstantsDBus::NO_CODE)
+        }
+    }
+
+    def private generateStatisticsHeader(FInterface _interface,
+                                         PropertyAccessor _accessor,
+                                         IResource _modelid) '''
+        «generateCommonApiDBusLicenseHeader()»
+        #ifndef «_interface.defineName»_DBUS_STATISTICS_HPP_
+        #define «_interface.defineName»_DBUS_STATISTICS_HPP_
+
+        #include <CommonAPI/Types.hpp>
+
+        #include <atomic>
+        #include <chrono>
+        #include <cstddef>
+        #include <cstdint>
+
+        «_interface.generateVersionNamespaceBegin»
+        «_interface.model.generateNamespaceBeginDeclaration»
+
+        /**
+         * Call statistics of the methods of «_interface.elementName». All proxies count
+         * into one instance, each stub adapter into its own. The counters are updated with relaxed
+         * atomic operations, so they are only consistent with each other once no calls
+         * are running.
+         */
+        class «_interface.dbusStatisticsClassName» {
+        public:
+            static const std::size_t numberOfMethods = «_interface.methods.size»;
+
+            // Bucket 0 counts the calls that took less than a microsecond, bucket i
+            // those below 2^i microseconds and the last bucket all longer calls.
+            static const std::size_t numberOfLatencyBuckets = 24;
+
+            struct Counters {
+                std::atomic<uint64_t> calls_;
+                std::atomic<uint64_t> errors_;
+                std::atomic<uint64_t> inFlight_;
+                std::atomic<uint64_t> latency_;
+                std::atomic<uint64_t> latencies_[numberOfLatencyBuckets];
+            };
+
+            // Measures a call from its construction to its destruction. The call
+            // failed if the status it refers to is not SUCCESS by then.
+            class Call {
+            public:
+                Call(«_interface.dbusStatisticsClassName» &_statistics, std::size_t _method, const CommonAPI::CallStatus &_status)
+                    : statistics_(_statistics), method_(_method), status_(_status), start_(_statistics.begin(_method)) {}
+                ~Call() {
+                    statistics_.end(method_, start_, status_ != CommonAPI::CallStatus::SUCCESS);
+                }
+
+            private:
+                Call(const Call &);
+                Call &operator=(const Call &);
+
+                «_interface.dbusStatisticsClassName» &statistics_;
+                const std::size_t method_;
+                const CommonAPI::CallStatus &status_;
+                const std::chrono::steady_clock::time_point start_;
+            };
+
+            static «_interface.dbusStatisticsClassName» &getProxyStatistics() {
+                static «_interface.dbusStatisticsClassName» itsStatistics;
+                return itsStatistics;
+            }
+
+            // Makes the given statistics the ones that the stub dispatchers count into
+            // on this thread, until it is destroyed.
+            class Dispatch {
+            public:
+                Dispatch(«_interface.dbusStatisticsClassName» &_statistics)
+                    : previous_(getDispatchStatistics()) {
+                    getDispatchStatistics() = &_statistics;
+                }
+                ~Dispatch() {
+                    getDispatchStatistics() = previous_;
+                }
+
+            private:
+                Dispatch(const Dispatch &);
+                Dispatch &operator=(const Dispatch &);
+
+                «_interface.dbusStatisticsClassName» *previous_;
+            };
+
+            // The statistics of the stub adapter that dispatches a call on this thread.
+            static «_interface.dbusStatisticsClassName» *&getDispatchStatistics() {
+                static thread_local «_interface.dbusStatisticsClassName» *itsStatistics(nullptr);
+                return itsStatistics;
+            }
+
+            static const char *getMethodName(std::size_t _method) {
+                static const char *itsNames[numberOfMethods] = {
+                    «_interface.methods.map['"' + elementName + '"'].join(',\n')»
+                };
+                return (_method < numberOfMethods ? itsNames[_method] : nullptr);
+            }
+
+            // The D-Bus signature of the in arguments, which tells overloads apart.
+            static const char *getMethodSignature(std::size_t _method) {
+                static const char *itsSignatures[numberOfMethods] = {
+                    «_interface.methods.map['"' + dbusInSignature(_accessor) + '"'].join(',\n')»
+                };
+                return (_method < numberOfMethods ? itsSignatures[_method] : nullptr);
+            }
+
+            «_interface.dbusStatisticsClassName»() {
+                for (std::size_t i = 0; i < numberOfMethods; i++) {
+                    counters_[i].inFlight_.store(0, std::memory_order_relaxed);
+                }
+                reset();
+            }
+
+            const Counters &getCounters(std::size_t _method) const {
+                return counters_[_method];
+            }
+
+            // Calls that are running are not reset, they are counted when they end.
+            void reset() {
+                for (std::size_t i = 0; i < numberOfMethods; i++) {
+                    Counters &itsCounters = counters_[i];
+                    itsCounters.calls_.store(0, std::memory_order_relaxed);
+                    itsCounters.errors_.store(0, std::memory_order_relaxed);
+                    itsCounters.latency_.store(0, std::memory_order_relaxed);
+                    for (std::size_t j = 0; j < numberOfLatencyBuckets; j++) {
+                        itsCounters.latencies_[j].store(0, std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            // The latency in microseconds that the given percentage of the calls did not
+            // exceed, rounded up to the bound of its bucket. Calls in the last bucket are
+            // reported with its lower bound. 0 if the method was not called.
+            uint64_t getLatencyPercentile(std::size_t _method, unsigned _percent) const {
+                const Counters &itsCounters = counters_[_method];
+                uint64_t itsCalls[numberOfLatencyBuckets];
+                uint64_t itsTotal(0);
+                for (std::size_t i = 0; i < numberOfLatencyBuckets; i++) {
+                    itsCalls[i] = itsCounters.latencies_[i].load(std::memory_order_relaxed);
+                    itsTotal += itsCalls[i];
+                }
+                if (itsTotal == 0) {
+                    return 0;
+                }
+
+                const uint64_t itsRank = (itsTotal * _percent + 99) / 100;
+                uint64_t itsCount(0);
+                std::size_t itsBucket = 0;
+                while (itsBucket < numberOfLatencyBuckets - 1) {
+                    itsCount += itsCalls[itsBucket];
+                    if (itsCount >= itsRank) {
+                        return uint64_t(1) << itsBucket;
+                    }
+                    itsBucket++;
+                }
+                return uint64_t(1) << (numberOfLatencyBuckets - 2);
+            }
+
+            std::chrono::steady_clock::time_point begin(std::size_t _method) {
+                counters_[_method].inFlight_.fetch_add(1, std::memory_order_relaxed);
+                return std::chrono::steady_clock::now();
+            }
+
+            void end(std::size_t _method, const std::chrono::steady_clock::time_point &_start, bool _isError) {
+                const uint64_t itsLatency = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - _start).count());
+                std::size_t itsBucket = 0;
+                while (itsBucket < numberOfLatencyBuckets - 1 && (uint64_t(1) << itsBucket) <= itsLatency) {
+                    itsBucket++;
+                }
+
+                Counters &itsCounters = counters_[_method];
+                itsCounters.inFlight_.fetch_sub(1, std::memory_order_relaxed);
+                itsCounters.calls_.fetch_add(1, std::memory_order_relaxed);
+                if (_isError) {
+                    itsCounters.errors_.fetch_add(1, std::memory_order_relaxed);
+                }
+                itsCounters.latency_.fetch_add(itsLatency, std::memory_order_relaxed);
+                itsCounters.latencies_[itsBucket].fetch_add(1, std::memory_order_relaxed);
+            }
+
+        private:
+            «_interface.dbusStatisticsClassName»(const «_interface.dbusStatisticsClassName» &);
+            «_interface.dbusStatisticsClassName» &operator=(const «_interface.dbusStatisticsClassName» &);
+
+            Counters counters_[numberOfMethods];
+        };
+
+        «_interface.model.generateNamespaceEndDeclaration»
+        «_interface.generateVersionNamespaceEnd»
+
+        #endif // «_interface.defineName»_DBUS_STATISTICS_HPP_
+    '''
+}
@@ -23,17 +23,27 @@ import org.genivi.commonapi.dbus.preferences.PreferenceConstantsDBus
 import org.genivi.commonapi.dbus.preferences.FPreferencesDBus
 import java.util.List
 import org.franca.deploymodel.dsl.fDeploy.FDProvider
-import org.franca.deploymodel.core.FDeployedProvider
 import java.util.LinkedList
+import java.util.TreeMap
+import java.util.LinkedHashMap
 
 class FInterfaceDBusStubAdapterGenerator {
     @Inject private extension FrancaGeneratorExtensions
     @Inject private extension FrancaDBusGeneratorExtensions
     @Inject private extension FrancaDBusDeploymentAccessorHelper
 
+    var boolean generateStaticDispatch = false
+    var boolean generateExplicitInstantiation = false
+    var boolean generateStatisticsInterface = false
+    var boolean generateAttributeBatch = false
+
     def generateDBusStubAdapter(FInterface fInterface, IFileSystemAccess fileSystemAccess, PropertyAccessor deploymentAccessor,  List<FDProvider> providers, IResource modelid) {
 
         if(FPreferencesDBus::getInstance.getPreference(PreferenceConstantsDBus::P_GENERATE_CODE_DBUS, "true").equals("true")) {
+            generateStaticDispatch = FPreferencesDBus::getInstance.getPreference(PreferenceConstantsDBus::P_GENERATE_STATIC_DISPATCH_DBUS, "false").equals("true")
+            generateExplicitInstantiation = FPreferencesDBus::getInstance.getPreference(PreferenceConstantsDBus::P_GENERATE_EXPLICIT_INSTANTIATION_DBUS, "false").equals("true")
+            generateStatisticsInterface = FPreferencesDBus::getInstance.getPreference(PreferenceConstantsDBus::P_GENERATE_STATISTICS_INTERFACE_DBUS, "false").equals("true")
+            generateAttributeBatch = FPreferencesDBus::getInstance.getPreference(PreferenceConstantsDBus::P_GENERATE_ATTRIBUTE_BATCH_DBUS, "false").equals("true")
             fileSystemAccess.generateFile(fInterface.dbusStubAdapterHeaderPath, PreferenceConstantsDBus.P_OUTPUT_STUBS_DBUS,
                     fInterface.generateDBusStubAdapterHeader(deploymentAccessor, modelid))
             fileSystemAccess.generateFile(fInterface.dbusStubAdapterSourcePath,  PreferenceConstantsDBus.P_OUTPUT_STUBS_DBUS,
@@ -60,6 +70,9 @@ class FInterfaceDBusStubAdapterGenerator {
             #include <«fInterface.base.dbusStubAdapterHeaderPath»>
         «ENDIF»
         #include "«fInterface.dbusDeploymentHeaderPath»"
+        «IF fInterface.hasDBusStatistics»
+            #include "«fInterface.dbusStatisticsHeaderPath»"
+        «ENDIF»
         «val DeploymentHeaders = fInterface.getDeploymentInputIncludes(deploymentAccessor)»
         «DeploymentHeaders.map["#include <" + it + ">"].join("\n")»
 
@@ -78,12 +91,48 @@ class FInterfaceDBusStubAdapterGenerator {
             #include <CommonAPI/DBus/DBusFreedesktopStubAdapterHelper.hpp>
         «ENDIF»
         #include <CommonAPI/DBus/DBusDeployment.hpp>
+        «IF fInterface.hasFreedesktopAttributes(deploymentAccessor)»
+            #include <CommonAPI/DBus/DBusClientId.hpp>
+            #include <CommonAPI/DBus/DBusInputStream.hpp>
+        «ENDIF»
+        «IF fInterface.hasStatisticsInterface || fInterface.hasFreedesktopAttributes(deploymentAccessor)»
+            #include <CommonAPI/DBus/DBusOutputStream.hpp>
+        «ENDIF»
 
         #undef COMMONAPI_INTERNAL_COMPILATION
 
+        «IF generateStaticDispatch || fInterface.hasSelectiveFanOut(deploymentAccessor) || fInterface.hasStatisticsInterface»
+            #include <cstring>
+        «ENDIF»
+        «IF fInterface.hasStatisticsInterface»
+            #include <memory>
+        «ENDIF»
+        «IF generateAttributeBatch || fInterface.broadcasts.exists[selective]»
+            #include <mutex>
+        «ENDIF»
+        «IF fInterface.hasStatisticsInterface»
+            #include <sstream>
+        «ENDIF»
+        «IF fInterface.hasStatisticsInterface || fInterface.hasBatchedProperties(deploymentAccessor) || fInterface.hasFreedesktopAttributes(deploymentAccessor)»
+            #include <string>
+        «ENDIF»
+        «IF !generateStaticDispatch || !fInterface.managedInterfaces.empty || fInterface.hasBatchedProperties(deploymentAccessor) || fInterface.hasFreedesktopAttributes(deploymentAccessor)»
+            #include <unordered_map>
+        «ENDIF»
+        «IF !fInterface.managedInterfaces.empty || fInterface.hasDBusStatistics || fInterface.hasDBusSharedBuffers(deploymentAccessor)»
+            #include <utility>
+        «ENDIF»
+        «IF !fInterface.managedInterfaces.empty || fInterface.hasBatchedProperties(deploymentAccessor)»
+            #include <vector>
+        «ENDIF»
+
         «fInterface.generateVersionNamespaceBegin»
         «fInterface.model.generateNamespaceBeginDeclaration»
 
+        «IF fInterface.hasDBusStatistics»
+            «fInterface.generateStatisticsStubDispatcher»
+
+        «ENDIF»
         template <typename _Stub = «fInterface.stubFullClassName», typename... _Stubs>
         class «fInterface.dbusStubAdapterClassNameInternal»
             : public virtual «fInterface.stubAdapterClassName»,
@@ -112,6 +161,28 @@ class FInterfaceDBusStubAdapterGenerator {
                 «ENDIF»
 
             «ENDFOR»
+            «IF generateAttributeBatch»
+                «IF fInterface.base == null»
+                    // Attribute change notifications issued between beginAttributeBatch() and
+                    // commitAttributeBatch() are held back and sent on commit, last value wins.
+                    // Batches nest; only committing the outermost one sends the notifications.
+                    // The freedesktop properties of the interface and its base interfaces are
+                    // sent in a single PropertiesChanged signal. Commits are not rate-limited,
+                    // every outermost commit sends the changes it holds immediately.
+                    void beginAttributeBatch();
+                «ELSE»
+                    // Commits the attribute batch of this interface and all its base interfaces.
+                «ENDIF»
+                virtual void commitAttributeBatch();
+
+            «ENDIF»
+            «IF fInterface.hasDBusStatistics»
+                // The calls of the methods of «fInterface.elementName» that this adapter dispatched.
+                std::shared_ptr<«fInterface.dbusStatisticsClassName»> get«fInterface.dbusStatisticsClassName»() const {
+                    return «fInterface.dbusStatisticsMemberName»;
+                }
+
+            «ENDIF»
             «FOR broadcast: fInterface.broadcasts»
                 «FTypeGenerator::generateComments(broadcast, false)»
                 «IF broadcast.selective»
@@ -129,28 +200,28 @@ class FInterfaceDBusStubAdapterGenerator {
             «ENDFOR»
             «FOR managed: fInterface.managedInterfaces»
                 «managed.stubRegisterManagedMethod»;
+                // Registers all given (instance, stub) pairs and returns the number of registered instances.
+                std::size_t «managed.stubRegisterManagedName»Batch(const std::vector<std::pair<std::string, std::shared_ptr<«managed.stubFullClassName»>>> &_instances);
                 bool «managed.stubDeregisterManagedName»(const std::string&);
                 std::set<std::string>& «managed.stubManagedSetGetterName»();
 
             «ENDFOR»
             void deactivateManagedInstances() {
             «IF !fInterface.managedInterfaces.empty»
-                std::set<std::string>::iterator iter;
-                std::set<std::string>::iterator iterNext;
+                // All children are unexported in one pass over the adapter handles,
+                // without looking them up in the factory one by one.
+                std::shared_ptr<CommonAPI::DBus::Factory> itsFactory = CommonAPI::DBus::Factory::get();
+                auto itsObjectManager = CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::connection_->getDBusObjectManager();
+                const std::string adapterObjectPath(CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::getDBusAddress().getObjectPath());
 
             «ENDIF»
             «FOR managed : fInterface.managedInterfaces»
-                iter = «managed.stubManagedSetName».begin();
-                while (iter != «managed.stubManagedSetName».end()) {
-                    iterNext = std::next(iter);
-
-                    if («managed.stubDeregisterManagedName»(*iter)) {
-                        iter = iterNext;
-                    }
-                    else {
-                        iter++;
-                    }
+                for (auto &managedStubAdapter : «managed.stubManagedAdaptersName») {
+                    itsObjectManager->unexportManagedDBusStubAdapter(adapterObjectPath, managedStubAdapter.second);
+                    itsFactory->unregisterManagedService(managedStubAdapter.second->getAddress().getAddress());
                 }
+                «managed.stubManagedAdaptersName».clear();
+                «managed.stubManagedSetName».clear();
             «ENDFOR»
             }
 
@@ -167,14 +238,12 @@ class FInterfaceDBusStubAdapterGenerator {
                     return CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::deinit();
                 }
 
-                virtual bool onInterfaceDBusMessage(const CommonAPI::DBus::DBusMessage& dbusMessage) {
-                    return CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::onInterfaceDBusMessage(dbusMessage);
-                }
-
-                virtual bool onInterfaceDBusFreedesktopPropertiesMessage(const CommonAPI::DBus::DBusMessage& dbusMessage) {
-                    return CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::onInterfaceDBusFreedesktopPropertiesMessage(dbusMessage);
-                }
+                «IF !fInterface.hasFreedesktopAttributes(deploymentAccessor)»
+                    virtual bool onInterfaceDBusFreedesktopPropertiesMessage(const CommonAPI::DBus::DBusMessage& dbusMessage) {
+                        return CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::onInterfaceDBusFreedesktopPropertiesMessage(dbusMessage);
+                    }
 
+                «ENDIF»
             «ENDIF»
             static CommonAPI::DBus::DBusGetAttributeStubDispatcher<
                 «fInterface.stubFullClassName»,
@@ -204,105 +273,80 @@ class FInterfaceDBusStubAdapterGenerator {
               «IF fInterface.base != null»
                   «fInterface.base.getTypeCollectionName(fInterface)»DBusStubAdapterInternal<_Stub, _Stubs...>(_address, _connection, _stub) {
               «ENDIF»
-                «IF deploymentAccessor.getPropertiesType(fInterface) != PropertyAccessor.PropertiesType.freedesktop»
-                    «FOR attribute : fInterface.attributes»
-                        «FTypeGenerator::generateComments(attribute, false)»
-                        «dbusDispatcherTableEntry(fInterface, attribute.dbusGetMethodName, "", attribute.dbusGetStubDispatcherVariable)»
-                        «IF !attribute.isReadonly»
-                            «dbusDispatcherTableEntry(fInterface, attribute.dbusSetMethodName, attribute.dbusSignature(deploymentAccessor), attribute.dbusSetStubDispatcherVariable)»
-                        «ENDIF»
-                    «ENDFOR»
-                «ENDIF»
-                «FOR method : fInterface.methods»
-                    «FTypeGenerator::generateComments(method, false)»
-                    «IF methodnumberMap.get(method)==0»
-                        «dbusDispatcherTableEntry(fInterface, method.elementName, method.dbusInSignature(deploymentAccessor), method.dbusStubDispatcherVariable)»
-                    «ELSE»
-                        «dbusDispatcherTableEntry(fInterface, method.elementName, method.dbusInSignature(deploymentAccessor), method.dbusStubDispatcherVariable+methodnumberMap.get(method))»
-                    «ENDIF»
-                «ENDFOR»
-                «FOR broadcast : fInterface.broadcasts.filter[selective]»
-                    «dbusDispatcherTableEntry(fInterface, broadcast.subscribeSelectiveMethodName, "", broadcast.dbusStubDispatcherVariableSubscribe)»
-                    «dbusDispatcherTableEntry(fInterface, broadcast.unsubscribeSelectiveMethodName, "", broadcast.dbusStubDispatcherVariableUnsubscribe)»
-                «ENDFOR»
-                «fInterface.generateStubAttributeTableInitializer(deploymentAccessor)»
                 «FOR broadcast : fInterface.broadcasts»
                     «IF broadcast.selective»
                         «broadcast.getStubAdapterClassSubscriberListPropertyName» = std::make_shared<CommonAPI::ClientIdList>();
                     «ENDIF»
                 «ENDFOR»
-                «fInterface.dbusStubAdapterHelperClassName»::addStubDispatcher({ "getInterfaceVersion", "" }, &get«fInterface.elementName»InterfaceVersionStubDispatcher);
+                «IF fInterface.hasDBusStatistics»
+                    «fInterface.dbusStatisticsMemberName» = std::make_shared<«fInterface.dbusStatisticsClassName»>();
+                «ENDIF»
             }
 
+            «IF generateStaticDispatch»
+                «fInterface.generateStaticDispatch(deploymentAccessor, methodnumberMap)»
+            «ELSE»
+                «fInterface.generateTableDispatch(deploymentAccessor, methodnumberMap)»
+            «ENDIF»
+            «IF fInterface.hasFreedesktopAttributes(deploymentAccessor)»
+
+                «fInterface.generateFreedesktopPropertiesDispatch(deploymentAccessor)»
+            «ENDIF»
+
         protected:
             virtual const char* getMethodsDBusIntrospectionXmlData() const {
-                static const std::string introspectionData =
-                    «IF fInterface.base != null»
-                        std::string(«fInterface.base.getTypeCollectionName(fInterface)»DBusStubAdapterInternal<_Stub, _Stubs...>::getMethodsDBusIntrospectionXmlData()) +
-                    «ELSE»
-                        "<method name=\"getInterfaceVersion\">\n"
-                            "<arg name=\"value\" type=\"uu\" direction=\"out\" />"
-                        "</method>\n"
-                    «ENDIF»
-                    «FOR attribute : fInterface.attributes»
-                        «IF deploymentAccessor.getPropertiesType(attribute.containingInterface) == PropertyAccessor.PropertiesType.freedesktop»
-                            "<property name=\"«attribute.elementName»\" type=\"«attribute.dbusSignature(deploymentAccessor)»\" access=\"read«IF !attribute.readonly»write«ENDIF»\" />\n"
-                        «ELSE»
-                            "<method name=\"«attribute.dbusGetMethodName»\">\n"
-                            "<arg name=\"value\" type=\"«attribute.dbusSignature(deploymentAccessor)»\" direction=\"out\" />"
-                            "</method>\n"
-                            «IF !attribute.isReadonly»
-                                "<method name=\"«attribute.dbusSetMethodName»\">\n"
-                                "<arg name=\"requestedValue\" type=\"«attribute.dbusSignature(deploymentAccessor)»\" direction=\"in\" />\n"
-                                "<arg name=\"setValue\" type=\"«attribute.dbusSignature(deploymentAccessor)»\" direction=\"out\" />\n"
-                                "</method>\n"
-                            «ENDIF»
-                            «IF attribute.isObservable»
-                                "<signal name=\"«attribute.dbusSignalName»\">\n"
-                                "<arg name=\"changedValue\" type=\"«attribute.dbusSignature(deploymentAccessor)»\" />\n"
-                                "</signal>\n"
-                            «ENDIF»
-                        «ENDIF»
-                    «ENDFOR»
-                    «FOR broadcast : fInterface.broadcasts»
-                        «IF !broadcast.isErrorType(deploymentAccessor)»
-                            «FTypeGenerator::generateComments(broadcast, false)»
-                            "<signal name=\"«broadcast.elementName»\">\n"
-                            «FOR outArg : broadcast.outArgs»
-                                "<arg name=\"«outArg.elementName»\" type=\"«outArg.getTypeDbusSignature(deploymentAccessor)»\" />\n"
-                            «ENDFOR»
-                            "</signal>\n"
-                        «ENDIF»
-                    «ENDFOR»
-                    «FOR method : fInterface.methods»
-                        «FTypeGenerator::generateComments(method, false)»
-                        "<method name=\"«method.elementName»\">\n"
-                        «FOR inArg : method.inArgs»
-                            "<arg name=\"_«inArg.elementName»\" type=\"«inArg.getTypeDbusSignature(deploymentAccessor)»\" direction=\"in\" />\n"
-                        «ENDFOR»
-                        «IF method.hasError»
-                            "<arg name=\"_error\" type=\"«method.dbusErrorSignature(deploymentAccessor)»\" direction=\"out\" />\n"
-                        «ENDIF»
-                        «FOR outArg : method.outArgs»
-                            "<arg name=\"_«outArg.elementName»\" type=\"«outArg.getTypeDbusSignature(deploymentAccessor)»\" direction=\"out\" />\n"
-                        «ENDFOR»
-                        "</method>\n"
-                    «ENDFOR»
-                    «IF fInterface.attributes.empty && fInterface.broadcasts.empty && fInterface.methods.empty»
-                        ""
-                    «ENDIF»
+                static constexpr char introspectionData[] =
+                    «fInterface.generateIntrospectionXmlData(deploymentAccessor)»
                     ;
-                return introspectionData.c_str();
+                return introspectionData;
             }
+            «IF generateAttributeBatch»
+
+                «IF fInterface.base == null»
+                    std::mutex attributeBatchMutex_;
+                    uint32_t attributeBatchDepth_ = 0;
+                «ENDIF»
+                «FOR attribute : fInterface.attributes.filter[isObservable()]»
+                    bool «attribute.attributeBatchPendingName» = false;
+                    «attribute.getTypeName(fInterface, true)» «attribute.attributeBatchValueName»;
+                «ENDFOR»
+            «ENDIF»
 
         private:
+            «IF fInterface.hasSelectiveFanOut(deploymentAccessor)»
+                // Sends a copy of the already marshalled _signal to _client.
+                void sendSignalCopy(const CommonAPI::DBus::DBusMessage &_signal, const std::shared_ptr<CommonAPI::ClientId> _client) {
+                    std::shared_ptr<CommonAPI::DBus::DBusClientId> dbusClient = std::dynamic_pointer_cast<CommonAPI::DBus::DBusClientId, CommonAPI::ClientId>(_client);
+                    if (!dbusClient) {
+                        return;
+                    }
+
+                    CommonAPI::DBus::DBusMessage message = CommonAPI::DBus::DBusMessage::createSignal(
+                        _signal.getObjectPath(), _signal.getInterface(), _signal.getMember(), _signal.getSignature());
+                    message.setDestination(dbusClient->getDBusId());
+                    const int bodyLength = _signal.getBodyLength();
+                    if (bodyLength > 0) {
+                        if (!message.setBodyLength(bodyLength)) {
+                            return;
+                        }
+                        std::memcpy(message.getBodyData(), _signal.getBodyData(), size_t(bodyLength));
+                    }
+                    getDBusConnection()->sendDBusMessage(message);
+                }
+
+            «ENDIF»
+            «IF fInterface.hasDBusStatistics»
+                std::shared_ptr<«fInterface.dbusStatisticsClassName»> «fInterface.dbusStatisticsMemberName»;
+            «ENDIF»
             «FOR broadcast: fInterface.broadcasts»
                 «IF broadcast.selective»
+                    // Serializes writers of the subscriber set; senders do not take it.
                     std::mutex «broadcast.className»Mutex_;
                 «ENDIF»
             «ENDFOR»
             «FOR managed: fInterface.managedInterfaces»
                 std::set<std::string> «managed.stubManagedSetName»;
+                std::unordered_map<std::string, std::shared_ptr<CommonAPI::DBus::DBusStubAdapter>> «managed.stubManagedAdaptersName»;
             «ENDFOR»
         };
 
@@ -327,10 +371,24 @@ class FInterfaceDBusStubAdapterGenerator {
             «FTypeGenerator::generateComments(attribute, false)»
             template <typename _Stub, typename... _Stubs>
             void «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«attribute.stubAdapterClassFireChangedMethodName»(const «attribute.getTypeName(fInterface, true)»& value) {
+                «IF generateAttributeBatch»
+                    {
+                        std::lock_guard<std::mutex> itsLock(this->attributeBatchMutex_);
+                        if (this->attributeBatchDepth_ > 0) {
+                            «attribute.attributeBatchValueName» = value;
+                            «attribute.attributeBatchPendingName» = true;
+                            return;
+                        }
+                    }
+                «ENDIF»
                 «attribute.generateFireChangedMethodBody(fInterface, deploymentAccessor)»
             }
 
         «ENDFOR»
+        «IF generateAttributeBatch»
+            «fInterface.generateAttributeBatchDefinitions(deploymentAccessor)»
+        «ENDIF»
+
         «FOR broadcast: fInterface.broadcasts»
             «FTypeGenerator::generateComments(broadcast, false)»
             «IF broadcast.selective»
@@ -369,31 +427,68 @@ class FInterfaceDBusStubAdapterGenerator {
                 }
                 template <typename _Stub, typename... _Stubs>
                 void «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«broadcast.stubAdapterClassSendSelectiveMethodName»(«generateSendSelectiveSignatur(broadcast, fInterface, false)») {
-                    std::shared_ptr<CommonAPI::ClientIdList> actualReceiverList = _receivers;
-
-                    if (!_receivers) {
-                        std::lock_guard < std::mutex > itsLock(«broadcast.className»Mutex_);
-                        actualReceiverList = «broadcast.stubAdapterClassSubscriberListPropertyName»;
-                    }
+                    // Subscribe and unsubscribe replace the subscriber set instead of modifying it.
+                    std::shared_ptr<CommonAPI::ClientIdList> subscribers = std::atomic_load(&«broadcast.stubAdapterClassSubscriberListPropertyName»);
+                    std::shared_ptr<CommonAPI::ClientIdList> actualReceiverList = (_receivers ? _receivers : subscribers);
 
+                    «IF !broadcast.hasSelectiveFanOut(deploymentAccessor)»
                     for (auto clientIdIterator = actualReceiverList->cbegin(); clientIdIterator != actualReceiverList->cend(); clientIdIterator++) {
-                        bool found(false);
+                        if (!_receivers || subscribers->find(*clientIdIterator) != subscribers->end()) {
+                            «broadcast.stubAdapterClassFireSelectiveMethodName»(*clientIdIterator«IF(!broadcast.outArgs.empty)», «ENDIF»«broadcast.outArgs.map["_" + elementName].join(', ')»);
+                        }
+                    }
+                    «ELSE»
+                    // The arguments are marshalled once, every receiver gets a copy of the body.
+                    CommonAPI::DBus::DBusMessage signal = CommonAPI::DBus::DBusMessage::createSignal(
+                        getDBusAddress().getObjectPath(), getDBusAddress().getInterface(),
+                        "«broadcast.elementName»", "«broadcast.dbusSignature(deploymentAccessor)»");
+                    «IF !broadcast.outArgs.empty»
                         {
-                            std::lock_guard < std::mutex > itsLock(«broadcast.className»Mutex_);
-                            found = («broadcast.stubAdapterClassSubscriberListPropertyName»->find(*clientIdIterator) != «broadcast.stubAdapterClassSubscriberListPropertyName»->end());
+                            CommonAPI::DBus::DBusOutputStream output(signal);
+                            if (!CommonAPI::DBus::DBusSerializableArguments<
+                            «FOR outArg : broadcast.outArgs SEPARATOR ","»
+                                «val String deploymentType = outArg.getDeploymentType(fInterface, true)»
+                                «IF deploymentType != "CommonAPI::EmptyDeployment" && deploymentType != ""»
+                                     CommonAPI::Deployable< «outArg.getTypeName(fInterface, true)», «deploymentType»>
+                                «ELSE»
+                                    «outArg.getTypeName(fInterface, true)»
+                                «ENDIF»
+                            «ENDFOR»
+                            >::serialize(output,
+                            «FOR outArg : broadcast.outArgs SEPARATOR ","»
+                                «val String deploymentType = outArg.getDeploymentType(fInterface, true)»
+                                «IF deploymentType != "CommonAPI::EmptyDeployment" && deploymentType != ""»
+                                    «val String deployment = outArg.getDeploymentRef(outArg.array, broadcast, fInterface, deploymentAccessor)»
+                                    CommonAPI::Deployable< «outArg.getTypeName(fInterface, true)», «deploymentType»>(_«outArg.name», «deployment»)
+                                «ELSE»
+                                    _«outArg.name»
+                                «ENDIF»
+                            «ENDFOR»
+                            )) {
+                                return;
+                            }
+                            output.flush();
                         }
-                        if (!_receivers || found) {
-                            «broadcast.stubAdapterClassFireSelectiveMethodName»(*clientIdIterator«IF(!broadcast.outArgs.empty)», «ENDIF»«broadcast.outArgs.map["_" + elementName].join(', ')»);
+                    «ENDIF»
+
+                    for (auto clientIdIterator = actualReceiverList->cbegin(); clientIdIterator != actualReceiverList->cend(); clientIdIterator++) {
+                        if (!_receivers || subscribers->find(*clientIdIterator) != subscribers->end()) {
+                            sendSignalCopy(signal, *clientIdIterator);
                         }
                     }
+                    «ENDIF»
                 }
                 template <typename _Stub, typename... _Stubs>
                 void «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«broadcast.subscribeSelectiveMethodName»(const std::shared_ptr<CommonAPI::ClientId> clientId, bool& success) {
                     bool ok = «fInterface.dbusStubAdapterHelperClassName»::stub_->«broadcast.subscriptionRequestedMethodName»(clientId);
                     if (ok) {
                         {
+                            // Copy on write: senders keep using the snapshot they loaded.
                             std::lock_guard<std::mutex> itsLock(«broadcast.className»Mutex_);
-                            «broadcast.stubAdapterClassSubscriberListPropertyName»->insert(clientId);
+                            std::shared_ptr<CommonAPI::ClientIdList> subscribers
+                                = std::make_shared<CommonAPI::ClientIdList>(*std::atomic_load(&«broadcast.stubAdapterClassSubscriberListPropertyName»));
+                            subscribers->insert(clientId);
+                            std::atomic_store(&«broadcast.stubAdapterClassSubscriberListPropertyName», subscribers);
                         }
                         «fInterface.dbusStubAdapterHelperClassName»::stub_->«broadcast.subscriptionChangedMethodName»(clientId, CommonAPI::SelectiveBroadcastSubscriptionEvent::SUBSCRIBED);
                         success = true;
@@ -406,13 +501,16 @@ class FInterfaceDBusStubAdapterGenerator {
                     «fInterface.dbusStubAdapterHelperClassName»::stub_->«broadcast.subscriptionChangedMethodName»(clientId, CommonAPI::SelectiveBroadcastSubscriptionEvent::UNSUBSCRIBED);
                     {
                         std::lock_guard<std::mutex> itsLock(«broadcast.className»Mutex_);
-                        «broadcast.stubAdapterClassSubscriberListPropertyName»->erase(clientId);
+                        std::shared_ptr<CommonAPI::ClientIdList> subscribers
+                            = std::make_shared<CommonAPI::ClientIdList>(*std::atomic_load(&«broadcast.stubAdapterClassSubscriberListPropertyName»));
+                        subscribers->erase(clientId);
+                        std::atomic_store(&«broadcast.stubAdapterClassSubscriberListPropertyName», subscribers);
                     }
                 }
                 template <typename _Stub, typename... _Stubs>
                 std::shared_ptr<CommonAPI::ClientIdList> const «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«broadcast.stubAdapterClassSubscribersMethodName»() {
-                    std::lock_guard<std::mutex> itsLock(«broadcast.className»Mutex_);
-                    return std::make_shared<CommonAPI::ClientIdList>(*«broadcast.stubAdapterClassSubscriberListPropertyName»);
+                    // The caller may modify the returned list, so it gets a copy of the snapshot.
+                    return std::make_shared<CommonAPI::ClientIdList>(*std::atomic_load(&«broadcast.stubAdapterClassSubscriberListPropertyName»));
                 }
             «ELSE»
                 «IF !broadcast.isErrorType(deploymentAccessor)»
@@ -464,6 +562,7 @@ class FInterfaceDBusStubAdapterGenerator {
                         bool isExported = CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::connection_->getDBusObjectManager()->exportManagedDBusStubAdapter(adapterObjectPath, stubAdapter);
                         if (isExported) {
                             «managed.stubManagedSetName».insert(_instance);
+                            «managed.stubManagedAdaptersName»[_instance] = stubAdapter;
                             return true;
                         } else {
                             itsFactory->unregisterManagedService(itsAddress);
@@ -473,19 +572,50 @@ class FInterfaceDBusStubAdapterGenerator {
                 return false;
             }
             template <typename _Stub, typename... _Stubs>
-            bool «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«managed.stubDeregisterManagedName»(const std::string &_instance) {
-                std::string itsAddress = "local:«managed.fullyQualifiedNameWithVersion»:" + _instance;
-                if («managed.stubManagedSetName».find(_instance) != «managed.stubManagedSetName».end()) {
-                    std::shared_ptr<CommonAPI::DBus::Factory> itsFactory = CommonAPI::DBus::Factory::get();
-                    std::shared_ptr<CommonAPI::DBus::DBusStubAdapter> stubAdapter
-                        = itsFactory->getRegisteredService(itsAddress);
-                    if (stubAdapter) {
-                        CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::connection_->getDBusObjectManager()->unexportManagedDBusStubAdapter(
-                            CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::getDBusAddress().getObjectPath(), stubAdapter);
-                        itsFactory->unregisterManagedService(itsAddress);
-                        «managed.stubManagedSetName».erase(_instance);
-                        return true;
+            std::size_t «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«managed.stubRegisterManagedName»Batch(const std::vector<std::pair<std::string, std::shared_ptr<«managed.stubFullClassName»>>> &_instances) {
+                std::shared_ptr<CommonAPI::DBus::Factory> itsFactory = CommonAPI::DBus::Factory::get();
+                auto itsTranslator = CommonAPI::DBus::DBusAddressTranslator::get();
+                auto itsObjectManager = CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::connection_->getDBusObjectManager();
+                const std::string adapterObjectPath(CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::getDBusAddress().getObjectPath());
+
+                // The address is built once and only its instance is replaced, so the
+                // translator does not need to parse an address string per instance.
+                CommonAPI::Address itsAddress("local", "«managed.fullyQualifiedNameWithVersion»", "");
+
+                std::size_t numberOfRegistered(0);
+                for (const auto &instance : _instances) {
+                    if («managed.stubManagedSetName».find(instance.first) != «managed.stubManagedSetName».end()) {
+                        continue;
                     }
+
+                    itsAddress.setInstance(instance.first);
+                    CommonAPI::DBus::DBusAddress itsDBusAddress;
+                    itsTranslator->translate(itsAddress, itsDBusAddress);
+
+                    auto stubAdapter = itsFactory->createDBusStubAdapter(instance.second, "«managed.fullyQualifiedNameWithVersion»", itsDBusAddress, CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::connection_);
+                    if (itsFactory->registerManagedService(stubAdapter)) {
+                        if (itsObjectManager->exportManagedDBusStubAdapter(adapterObjectPath, stubAdapter)) {
+                            «managed.stubManagedSetName».insert(instance.first);
+                            «managed.stubManagedAdaptersName»[instance.first] = stubAdapter;
+                            numberOfRegistered++;
+                        } else {
+                            itsFactory->unregisterManagedService(itsAddress.getAddress());
+                        }
+                    }
+                }
+                return numberOfRegistered;
+            }
+            template <typename _Stub, typename... _Stubs>
+            bool «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«managed.stubDeregisterManagedName»(const std::string &_instance) {
+                auto managedStubAdapter = «managed.stubManagedAdaptersName».find(_instance);
+                if (managedStubAdapter != «managed.stubManagedAdaptersName».end()) {
+                    std::shared_ptr<CommonAPI::DBus::DBusStubAdapter> stubAdapter = managedStubAdapter->second;
+                    CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::connection_->getDBusObjectManager()->unexportManagedDBusStubAdapter(
+                        CommonAPI::DBus::DBusStubAdapterHelper<_Stub, _Stubs...>::getDBusAddress().getObjectPath(), stubAdapter);
+                    CommonAPI::DBus::Factory::get()->unregisterManagedService(stubAdapter->getAddress().getAddress());
+                    «managed.stubManagedAdaptersName».erase(managedStubAdapter);
+                    «managed.stubManagedSetName».erase(_instance);
+                    return true;
                 }
                 return false;
             }
@@ -497,6 +627,10 @@ class FInterfaceDBusStubAdapterGenerator {
 
         «ENDFOR»
 
+        «IF fInterface.hasStatisticsInterface»
+            «fInterface.generateStatisticsStubAdapter»
+
+        «ENDIF»
         template <typename _Stub = «fInterface.stubFullClassName», typename... _Stubs>
         class «fInterface.dbusStubAdapterClassName»
             : public «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>,
@@ -515,10 +649,62 @@ class FInterfaceDBusStubAdapterGenerator {
                     _connection,
                     _stub) {
             }
+            «IF fInterface.interfaceChain.exists[hasDBusStatistics]»
+
+                // The dispatchers count the calls into the statistics of this adapter.
+                virtual bool onInterfaceDBusMessage(const CommonAPI::DBus::DBusMessage &_message) {
+                    «FOR itsInterface : fInterface.interfaceChain.filter[hasDBusStatistics]»
+                        «itsInterface.dbusStatisticsFullClassName»::Dispatch its«itsInterface.dbusStatisticsClassName»Dispatch(*this->get«itsInterface.dbusStatisticsClassName»());
+                    «ENDFOR»
+                    return «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::onInterfaceDBusMessage(_message);
+                }
+            «ENDIF»
+            «IF fInterface.hasStatisticsInterface»
+
+                ~«fInterface.dbusStubAdapterClassName»() {
+                    unregisterStatisticsStubAdapter();
+                }
+
+                // The factory registers the adapter after it is initialized. The statistics
+                // interface is not registered if the address already belongs to another
+                // adapter, as the registration of this one is going to fail then.
+                virtual void init(std::shared_ptr<CommonAPI::DBus::DBusStubAdapter> _instance) {
+                    «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::init(_instance);
+                    if (!statisticsStubAdapter_
+                            && !CommonAPI::DBus::Factory::get()->isRegisteredService(this->getAddress().getAddress())) {
+                        std::shared_ptr<CommonAPI::DBus::DBusStubAdapter> itsStatisticsStubAdapter
+                            = std::make_shared<«fInterface.dbusStatisticsClassName»StubAdapter>(this->getDBusAddress(), this->getDBusConnection()«FOR itsInterface : fInterface.interfaceChain.filter[hasDBusStatistics]»,
+                                this->get«itsInterface.dbusStatisticsClassName»()«ENDFOR»);
+                        if (this->getDBusConnection()->getDBusObjectManager()->registerDBusStubAdapter(itsStatisticsStubAdapter)) {
+                            statisticsStubAdapter_ = itsStatisticsStubAdapter;
+                        }
+                    }
+                }
+
+                virtual void deinit() {
+                    unregisterStatisticsStubAdapter();
+                    «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::deinit();
+                }
+
+            private:
+                void unregisterStatisticsStubAdapter() {
+                    if (statisticsStubAdapter_) {
+                        this->getDBusConnection()->getDBusObjectManager()->unregisterDBusStubAdapter(statisticsStubAdapter_);
+                        statisticsStubAdapter_.reset();
+                    }
+                }
+
+                std::shared_ptr<CommonAPI::DBus::DBusStubAdapter> statisticsStubAdapter_;
+            «ENDIF»
         };
 
         «fInterface.model.generateNamespaceEndDeclaration»
         «fInterface.generateVersionNamespaceEnd»
+        «IF generateExplicitInstantiation»
+
+            // Instantiated once in «fInterface.dbusStubAdapterSourceFile»
+            «fInterface.generateStubAdapterInstantiations("extern template class")»
+        «ENDIF»
 
         #endif // «fInterface.defineName»_DBUS_STUB_ADAPTER_HPP_
     '''
@@ -544,7 +730,12 @@ class FInterfaceDBusStubAdapterGenerator {
     def private generateMethodDispatcherDeclarations(FMethod fMethod, FInterface fInterface, HashMap<String, Integer> counterMap, HashMap<FMethod, Integer> methodnumberMap, PropertyAccessor deploymentAccessor) '''
             «FTypeGenerator::generateComments(fMethod, false)»
             «val accessor = getAccessor(fInterface)»
-            «IF !fMethod.isFireAndForget»
+            «IF fMethod.hasDBusSharedBuffers(deploymentAccessor)»
+                «val String dispatcher = fMethod.nextStubDispatcherVariable(counterMap, methodnumberMap)»
+                «fMethod.generateSharedBufferStubDispatcher(fInterface, dispatcher, accessor)»
+
+                static «fMethod.statisticsStubDispatcherBegin»«dispatcher.sharedBufferStubDispatcherClassName»«fMethod.statisticsStubDispatcherEnd» «dispatcher»;
+            «ELSEIF !fMethod.isFireAndForget»
                 «var errorReplyTypes = new LinkedList()»
                 «FOR broadcast : fInterface.broadcasts»
                     «IF broadcast.isErrorType(fMethod, deploymentAccessor)»
@@ -553,7 +744,7 @@ class FInterfaceDBusStubAdapterGenerator {
                     «ENDIF»
                 «ENDFOR»
                 
-                static CommonAPI::DBus::DBusMethodWithReplyStubDispatcher<
+                static «fMethod.statisticsStubDispatcherBegin»CommonAPI::DBus::DBusMethodWithReplyStubDispatcher<
                     «fInterface.stubFullClassName»,
                     std::tuple< «fMethod.allInTypes»>,
                     std::tuple< «fMethod.allOutTypes»>,
@@ -563,26 +754,250 @@ class FInterfaceDBusStubAdapterGenerator {
 
                     «IF !(counterMap.containsKey(fMethod.dbusStubDispatcherVariable))»
                         «{counterMap.put(fMethod.dbusStubDispatcherVariable, 0);  methodnumberMap.put(fMethod, 0);""}»
-                        > «fMethod.dbusStubDispatcherVariable»;
+                        >«fMethod.statisticsStubDispatcherEnd» «fMethod.dbusStubDispatcherVariable»;
                     «ELSE»
                         «{counterMap.put(fMethod.dbusStubDispatcherVariable, counterMap.get(fMethod.dbusStubDispatcherVariable) + 1);  methodnumberMap.put(fMethod, counterMap.get(fMethod.dbusStubDispatcherVariable));""}»
-                        > «fMethod.dbusStubDispatcherVariable»«Integer::toString(counterMap.get(fMethod.dbusStubDispatcherVariable))»;
+                        >«fMethod.statisticsStubDispatcherEnd» «fMethod.dbusStubDispatcherVariable»«Integer::toString(counterMap.get(fMethod.dbusStubDispatcherVariable))»;
                     «ENDIF»
             «ELSE»
-                static CommonAPI::DBus::DBusMethodStubDispatcher<
+                static «fMethod.statisticsStubDispatcherBegin»CommonAPI::DBus::DBusMethodStubDispatcher<
                     «fInterface.stubFullClassName»,
                     std::tuple< «fMethod.allInTypes»>,
                     std::tuple< «fMethod.inArgs.getDeploymentTypes(fInterface, accessor)»>
                     «IF !(counterMap.containsKey(fMethod.dbusStubDispatcherVariable))»
                         «{counterMap.put(fMethod.dbusStubDispatcherVariable, 0); methodnumberMap.put(fMethod, 0);""}»
-                        > «fMethod.dbusStubDispatcherVariable»;
+                        >«fMethod.statisticsStubDispatcherEnd» «fMethod.dbusStubDispatcherVariable»;
                     «ELSE»
                         «{counterMap.put(fMethod.dbusStubDispatcherVariable, counterMap.get(fMethod.dbusStubDispatcherVariable) + 1);  methodnumberMap.put(fMethod, counterMap.get(fMethod.dbusStubDispatcherVariable));""}»
-                        > «fMethod.dbusStubDispatcherVariable»«Integer::toString(counterMap.get(fMethod.dbusStubDispatcherVariable))»;
+                        >«fMethod.statisticsStubDispatcherEnd» «fMethod.dbusStubDispatcherVariable»«Integer::toString(counterMap.get(fMethod.dbusStubDispatcherVariable))»;
                     «ENDIF»
             «ENDIF»
     '''
 
+    // Name of the next dispatcher of the method, numbered like the generic dispatchers of overloaded methods
+    def private String nextStubDispatcherVariable(FMethod fMethod, HashMap<String, Integer> counterMap, HashMap<FMethod, Integer> methodnumberMap) {
+        if (!counterMap.containsKey(fMethod.dbusStubDispatcherVariable)) {
+            counterMap.put(fMethod.dbusStubDispatcherVariable, 0)
+            methodnumberMap.put(fMethod, 0)
+            return fMethod.dbusStubDispatcherVariable
+        }
+        counterMap.put(fMethod.dbusStubDispatcherVariable, counterMap.get(fMethod.dbusStubDispatcherVariable) + 1)
+        methodnumberMap.put(fMethod, counterMap.get(fMethod.dbusStubDispatcherVariable))
+        return fMethod.dbusStubDispatcherVariable + Integer::toString(counterMap.get(fMethod.dbusStubDispatcherVariable))
+    }
+
+    def private sharedBufferStubDispatcherClassName(String _dispatcher) {
+        'SharedBuffer' + _dispatcher.toFirstUpper
+    }
+
+    /**
+     * Dispatcher of a method with arguments deployed as DBusSharedBuffer. The generic
+     * dispatchers would deserialize the descriptor into the argument type, so the
+     * arguments are read and the reply is written here.
+     */
+    def private generateSharedBufferStubDispatcher(FMethod fMethod, FInterface fInterface, String _dispatcher, PropertyAccessor _accessor) '''
+        class «_dispatcher.sharedBufferStubDispatcherClassName»
+            : public CommonAPI::DBus::StubDispatcher< «fInterface.stubFullClassName» > {
+        public:
+            virtual bool dispatchDBusMessage(const CommonAPI::DBus::DBusMessage &_message,
+                                             const std::shared_ptr< «fInterface.stubFullClassName» > &_stub,
+                                             «fInterface.stubFullClassName»::RemoteEventHandlerType *_remoteEventHandler,
+                                             std::weak_ptr<CommonAPI::DBus::DBusProxyConnection> _connection) {
+                (void)_remoteEventHandler;
+                // Received descriptors are closed on every early return.
+                «FOR a : fMethod.inArgs.filter[isDBusSharedBuffer(_accessor)]»
+                    ::commonapi::dbus::ReceivedSharedBuffer received_«a.name»;
+                «ENDFOR»
+                CommonAPI::DBus::DBusInputStream itsInput(_message);
+                «FOR a : fMethod.inArgs»
+                    «IF a.isDBusSharedBuffer(_accessor)»
+                        CommonAPI::Deployable< uint32_t, CommonAPI::DBus::IntegerDeployment > deploy_«a.name»(&«fInterface.getFullName»_::sharedBufferDeployment);
+                        itsInput >> deploy_«a.name»;
+                        if (itsInput.hasError())
+                            return false;
+                        received_«a.name».reset(deploy_«a.name».getValue());
+                    «ELSE»
+                        CommonAPI::Deployable< «a.getTypeName(fMethod, true)», «a.getDeploymentType(fInterface, true)» > deploy_«a.name»(«a.getDeploymentRef(a.array, fMethod, fInterface, _accessor)»);
+                        itsInput >> deploy_«a.name»;
+                    «ENDIF»
+                «ENDFOR»
+                if (itsInput.hasError())
+                    return false;
+
+                «FOR a : fMethod.inArgs.filter[isDBusSharedBuffer(_accessor)]»
+                    «a.getTypeName(fMethod, true)» _«a.name»;
+                    if (!received_«a.name».read(_«a.name»))
+                        return false;
+                «ENDFOR»
+                std::shared_ptr<CommonAPI::DBus::DBusClientId> itsClient
+                    = std::make_shared<CommonAPI::DBus::DBusClientId>(std::string(_message.getSender()));
+                // The stub takes the arguments by value, the received buffers are moved into it.
+                «IF fMethod.isFireAndForget»
+                    _stub->«fMethod.elementName»(itsClient«FOR a : fMethod.inArgs», «IF a.isDBusSharedBuffer(_accessor)»std::move(_«a.name»)«ELSE»deploy_«a.name».getValue()«ENDIF»«ENDFOR»);
+                «ELSE»
+                    CommonAPI::DBus::DBusMessage itsCall(_message);
+                    _stub->«fMethod.elementName»(itsClient«FOR a : fMethod.inArgs», «IF a.isDBusSharedBuffer(_accessor)»std::move(_«a.name»)«ELSE»deploy_«a.name».getValue()«ENDIF»«ENDFOR»,
+                        [itsCall, _connection](«fMethod.outArgs.map['const ' + getTypeName(fMethod, true) + ' &_' + name].join(', ')») {
+                            CommonAPI::DBus::DBusMessage itsReply = itsCall.createMethodReturn("«fMethod.dbusOutSignature(_accessor)»");
+                            CommonAPI::DBus::DBusOutputStream itsOutput(itsReply);
+                            «FOR a : fMethod.outArgs»
+                                CommonAPI::Deployable< «a.getTypeName(fMethod, true)», «a.getDeploymentType(fInterface, true)» > deploy_«a.name»(_«a.name», «a.getDeploymentRef(a.array, fMethod, fInterface, _accessor)»);
+                                itsOutput << deploy_«a.name»;
+                            «ENDFOR»
+                            itsOutput.flush();
+                            std::shared_ptr<CommonAPI::DBus::DBusProxyConnection> itsConnection = _connection.lock();
+                            if (itsConnection)
+                                itsConnection->sendDBusMessage(itsReply);
+                        });
+                «ENDIF»
+                return true;
+            }
+        };
+    '''
+
+    // The dispatchers of an interface with statistics are wrapped in the class
+    // template below, which counts each dispatch.
+    def private statisticsStubDispatcherBegin(FMethod fMethod) {
+        val FInterface fInterface = fMethod.eContainer as FInterface
+        if (!fInterface.hasDBusStatistics)
+            return ""
+        return fInterface.dbusStatisticsClassName + "StubDispatcher< " + fMethod.dbusStatisticsIndex + ", "
+    }
+
+    def private statisticsStubDispatcherEnd(FMethod fMethod) {
+        val FInterface fInterface = fMethod.eContainer as FInterface
+        if (!fInterface.hasDBusStatistics)
+            return ""
+        return " >"
+    }
+
+    /**
+     * Counts the dispatch of a method in the statistics of the stub adapter that
+     * dispatches it. For stubs that reply asynchronously, the dispatch ends when
+     * the stub returns, not when it replies.
+     */
+    def private generateStatisticsStubDispatcher(FInterface fInterface) '''
+        template <std::size_t _Method, typename _Dispatcher>
+        class «fInterface.dbusStatisticsClassName»StubDispatcher : public _Dispatcher {
+        public:
+            template <typename... _Arguments>
+            «fInterface.dbusStatisticsClassName»StubDispatcher(_Arguments&&... _arguments)
+                : _Dispatcher(std::forward<_Arguments>(_arguments)...) {}
+
+            virtual bool dispatchDBusMessage(const CommonAPI::DBus::DBusMessage &_message,
+                                             const std::shared_ptr< «fInterface.stubFullClassName» > &_stub,
+                                             «fInterface.stubFullClassName»::RemoteEventHandlerType *_remoteEventHandler,
+                                             std::weak_ptr<CommonAPI::DBus::DBusProxyConnection> _connection) {
+                «fInterface.dbusStatisticsClassName» *itsStatistics = «fInterface.dbusStatisticsClassName»::getDispatchStatistics();
+                if (itsStatistics == nullptr) {
+                    return _Dispatcher::dispatchDBusMessage(_message, _stub, _remoteEventHandler, _connection);
+                }
+                const std::chrono::steady_clock::time_point itsStart = itsStatistics->begin(_Method);
+                const bool isDispatched = _Dispatcher::dispatchDBusMessage(_message, _stub, _remoteEventHandler, _connection);
+                itsStatistics->end(_Method, itsStart, !isDispatched);
+                return isDispatched;
+            }
+        };
+    '''
+
+    def private boolean hasStatisticsInterface(FInterface fInterface) {
+        return generateStatisticsInterface && fInterface.interfaceChain.exists[hasDBusStatistics]
+    }
+
+    def private dbusStatisticsMemberName(FInterface fInterface) {
+        return fInterface.elementName.toFirstLower + "DBusStatistics_"
+    }
+
+    def private dbusStatisticsFullClassName(FInterface fInterface) {
+        return fInterface.getFullName + "DBusStatistics"
+    }
+
+    /**
+     * Adapter of the org.genivi.commonapi.Statistics interface, which the stub adapter
+     * registers at its object path. Its only method returns the statistics that the
+     * stub adapter keeps for the interface and its bases as text in the Prometheus
+     * exposition format, so that a monitor gets all of them with a single call.
+     */
+    def private generateStatisticsStubAdapter(FInterface fInterface) '''
+        class «fInterface.dbusStatisticsClassName»StubAdapter : public CommonAPI::DBus::DBusStubAdapter {
+        public:
+            «fInterface.dbusStatisticsClassName»StubAdapter(
+                const CommonAPI::DBus::DBusAddress &_address,
+                const std::shared_ptr<CommonAPI::DBus::DBusProxyConnection> &_connection«FOR itsInterface : fInterface.interfaceChain.filter[hasDBusStatistics]»,
+                const std::shared_ptr<«itsInterface.dbusStatisticsFullClassName»> &_«itsInterface.dbusStatisticsMemberName»«ENDFOR»)
+                : CommonAPI::DBus::DBusStubAdapter(
+                    CommonAPI::DBus::DBusAddress(_address.getService(), _address.getObjectPath(), "org.genivi.commonapi.Statistics"),
+                    _connection,
+                    false)«FOR itsInterface : fInterface.interfaceChain.filter[hasDBusStatistics]»,
+                  «itsInterface.dbusStatisticsMemberName»(_«itsInterface.dbusStatisticsMemberName»)«ENDFOR» {
+            }
+
+            virtual void deactivateManagedInstances() {
+            }
+
+            virtual bool hasFreedesktopProperties() {
+                return false;
+            }
+
+            virtual const char *getMethodsDBusIntrospectionXmlData() const {
+                return "<method name=\"GetStatistics\">\n"
+                           "<arg name=\"statistics\" type=\"s\" direction=\"out\" />\n"
+                       "</method>\n";
+            }
+
+            virtual bool onInterfaceDBusMessage(const CommonAPI::DBus::DBusMessage &_message) {
+                const char *itsMember = _message.getMember();
+                const char *itsSignature = _message.getSignature();
+                if (itsMember == nullptr || std::strcmp(itsMember, "GetStatistics") != 0
+                        || itsSignature == nullptr || itsSignature[0] != '\0') {
+                    return false;
+                }
+                CommonAPI::DBus::DBusMessage itsReply = _message.createMethodReturn("s");
+                CommonAPI::DBus::DBusOutputStream itsOutput(itsReply);
+                itsOutput << getStatistics();
+                itsOutput.flush();
+                return getDBusConnection()->sendDBusMessage(itsReply);
+            }
+
+            virtual bool onInterfaceDBusFreedesktopPropertiesMessage(const CommonAPI::DBus::DBusMessage &_message) {
+                (void)_message;
+                return false;
+            }
+
+            std::string getStatistics() const {
+                std::ostringstream itsText;
+                «fInterface.generateStatisticsSamples("calls_total", "counter",
+                    "Calls dispatched to the stub.", "getCounters(i).calls_.load(std::memory_order_relaxed)")»
+                «fInterface.generateStatisticsSamples("errors_total", "counter",
+                    "Calls that could not be dispatched to the stub.", "getCounters(i).errors_.load(std::memory_order_relaxed)")»
+                «fInterface.generateStatisticsSamples("dispatch_in_flight", "gauge",
+                    "Calls the stub has not returned from yet; a later reply is not waited for.", "getCounters(i).inFlight_.load(std::memory_order_relaxed)")»
+                «fInterface.generateStatisticsSamples("dispatch_latency_p99_microseconds", "gauge",
+                    "Time until the stub returned that 99 percent of the calls did not exceed; a later reply is not waited for.", "getLatencyPercentile(i, 99)")»
+                return itsText.str();
+            }
+
+        private:
+            «FOR itsInterface : fInterface.interfaceChain.filter[hasDBusStatistics]»
+                const std::shared_ptr<«itsInterface.dbusStatisticsFullClassName»> «itsInterface.dbusStatisticsMemberName»;
+            «ENDFOR»
+        };
+    '''
+
+    // Samples of a metric family must not be interleaved with other families.
+    def private generateStatisticsSamples(FInterface fInterface, String _name, String _type, String _help, String _value) '''
+        itsText << "# HELP commonapi_dbus_«_name» «_help»\n"
+                << "# TYPE commonapi_dbus_«_name» «_type»\n";
+        «FOR itsInterface : fInterface.interfaceChain.filter[hasDBusStatistics]»
+            «val statistics = itsInterface.dbusStatisticsFullClassName»
+            for (std::size_t i = 0; i < «statistics»::numberOfMethods; i++) {
+                itsText << "commonapi_dbus_«_name»{interface=\"«itsInterface.fullyQualifiedName»\",member=\""
+                        << «statistics»::getMethodName(i) << "\",signature=\"" << «statistics»::getMethodSignature(i) << "\"} "
+                        << «itsInterface.dbusStatisticsMemberName»->«_value» << "\n";
+            }
+        «ENDFOR»
+    '''
+
     def private generateBroadcastDispatcherDeclarations(FBroadcast fBroadcast, FInterface fInterface) '''
         «IF fBroadcast.selective»
             static CommonAPI::DBus::DBusMethodWithReplyAdapterDispatcher<
@@ -638,7 +1053,12 @@ class FInterfaceDBusStubAdapterGenerator {
 
         «val accessor = getAccessor(fInterface)»
         «FTypeGenerator::generateComments(fMethod, false)»
-        «IF !fMethod.isFireAndForget»
+        «IF fMethod.hasDBusSharedBuffers(deploymentAccessor)»
+            «val String dispatcher = fMethod.nextStubDispatcherVariable(counterMap, methodnumberMap)»
+            template <typename _Stub, typename... _Stubs>
+            «fMethod.statisticsStubDispatcherBegin»typename «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«dispatcher.sharedBufferStubDispatcherClassName»«fMethod.statisticsStubDispatcherEnd»
+                «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«dispatcher»;
+        «ELSEIF !fMethod.isFireAndForget»
             «var errorReplyTypes = new LinkedList()»
             «var errorReplyCallbacks = new LinkedList()»
             «FOR broadcast : fInterface.broadcasts»
@@ -650,7 +1070,7 @@ class FInterfaceDBusStubAdapterGenerator {
                 «ENDIF»
             «ENDFOR»
             template <typename _Stub, typename... _Stubs>
-            CommonAPI::DBus::DBusMethodWithReplyStubDispatcher<
+            «fMethod.statisticsStubDispatcherBegin»CommonAPI::DBus::DBusMethodWithReplyStubDispatcher<
                 «fInterface.stubFullClassName»,
                 std::tuple< «fMethod.allInTypes»>,
                 std::tuple< «fMethod.allOutTypes»>,
@@ -660,30 +1080,30 @@ class FInterfaceDBusStubAdapterGenerator {
 
                 «IF !(counterMap.containsKey(fMethod.dbusStubDispatcherVariable))»
                     «{counterMap.put(fMethod.dbusStubDispatcherVariable, 0);  methodnumberMap.put(fMethod, 0);""}»
-                    > «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«fMethod.dbusStubDispatcherVariable»(
+                    >«fMethod.statisticsStubDispatcherEnd» «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«fMethod.dbusStubDispatcherVariable»(
                     &«fInterface.stubClassName + "::" + fMethod.elementName», "«fMethod.dbusOutSignature(deploymentAccessor)»",
                     «fMethod.getDeployments(fInterface, accessor, true, false)»,
                     «fMethod.getDeployments(fInterface, accessor, false, true)»«IF errorReplyCallbacks.size > 0»,«'\n' + errorReplyCallbacks.map[it].join(',\n')»«ENDIF»);
                 «ELSE»
                     «{counterMap.put(fMethod.dbusStubDispatcherVariable, counterMap.get(fMethod.dbusStubDispatcherVariable) + 1);  methodnumberMap.put(fMethod, counterMap.get(fMethod.dbusStubDispatcherVariable));""}»
-                    > «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«fMethod.dbusStubDispatcherVariable»«Integer::toString(counterMap.get(fMethod.dbusStubDispatcherVariable))»(&«fInterface.stubClassName + "::" + fMethod.elementName», "«fMethod.dbusOutSignature(deploymentAccessor)»",
+                    >«fMethod.statisticsStubDispatcherEnd» «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«fMethod.dbusStubDispatcherVariable»«Integer::toString(counterMap.get(fMethod.dbusStubDispatcherVariable))»(&«fInterface.stubClassName + "::" + fMethod.elementName», "«fMethod.dbusOutSignature(deploymentAccessor)»",
                     «fMethod.getDeployments(fInterface, accessor, true, false)»,
                     «fMethod.getDeployments(fInterface, accessor, false, true)»«IF errorReplyCallbacks.size > 0»,«'\n' + errorReplyCallbacks.map[it].join(',\n')»«ENDIF»);
                 «ENDIF»
         «ELSE»
             template <typename _Stub, typename... _Stubs>
-            CommonAPI::DBus::DBusMethodStubDispatcher<
+            «fMethod.statisticsStubDispatcherBegin»CommonAPI::DBus::DBusMethodStubDispatcher<
                 «fInterface.stubClassName»,
                 std::tuple< «fMethod.allInTypes»>,
                 std::tuple< «fMethod.inArgs.getDeploymentTypes(fInterface, accessor)»>
 
                 «IF !(counterMap.containsKey(fMethod.dbusStubDispatcherVariable))»
                     «{counterMap.put(fMethod.dbusStubDispatcherVariable, 0); methodnumberMap.put(fMethod, 0);""}»
-                    > «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«fMethod.dbusStubDispatcherVariable»(&«fInterface.stubClassName + "::" + fMethod.elementName»,
+                    >«fMethod.statisticsStubDispatcherEnd» «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«fMethod.dbusStubDispatcherVariable»(&«fInterface.stubClassName + "::" + fMethod.elementName»,
                     «fMethod.getDeployments(fInterface, accessor, true, false)»);
                 «ELSE»
                     «{counterMap.put(fMethod.dbusStubDispatcherVariable, counterMap.get(fMethod.dbusStubDispatcherVariable) + 1);  methodnumberMap.put(fMethod, counterMap.get(fMethod.dbusStubDispatcherVariable));""}»
-                    > «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«fMethod.dbusStubDispatcherVariable»«Integer::toString(counterMap.get(fMethod.dbusStubDispatcherVariable))»(&«fInterface.stubClassName + "::" + fMethod.elementName»,
+                    >«fMethod.statisticsStubDispatcherEnd» «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«fMethod.dbusStubDispatcherVariable»«Integer::toString(counterMap.get(fMethod.dbusStubDispatcherVariable))»(&«fInterface.stubClassName + "::" + fMethod.elementName»,
                     «fMethod.getDeployments(fInterface, accessor, true, false)»);
                 «ENDIF»
         «ENDIF»
@@ -707,6 +1127,25 @@ class FInterfaceDBusStubAdapterGenerator {
             > «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«fBroadcast.dbusStubDispatcherVariableUnsubscribe»(&«fInterface.stubAdapterClassName + "::" + fBroadcast.unsubscribeSelectiveMethodName», "");
     '''
 
+    // The stub adapter of a derived interface also instantiates the adapter
+    // templates of all its base interfaces with its own stub hierarchy.
+    def private generateStubAdapterInstantiations(FInterface fInterface, String _kind) '''
+        «FOR itsInterface : fInterface.interfaceChain.reverseView»
+            «_kind» «itsInterface.getFullName»DBusStubAdapterInternal<«fInterface.interfaceHierarchy»>;
+        «ENDFOR»
+        «_kind» «fInterface.getFullName»DBusStubAdapter<«fInterface.interfaceHierarchy»>;
+    '''
+
+    def private List<FInterface> getInterfaceChain(FInterface fInterface) {
+        val List<FInterface> chain = new LinkedList<FInterface>()
+        var FInterface itsInterface = fInterface
+        while (itsInterface != null) {
+            chain.add(itsInterface)
+            itsInterface = itsInterface.base
+        }
+        return chain
+    }
+
     def private String getInterfaceHierarchy(FInterface fInterface) {
         if (fInterface.base == null) {
             fInterface.stubFullClassName
@@ -731,16 +1170,7 @@ class FInterfaceDBusStubAdapterGenerator {
         }
 
         void initialize«fInterface.dbusStubAdapterClassName»() {
-             «FOR p : providers»
-                 «val PropertyAccessor providerAccessor = new PropertyAccessor(new FDeployedProvider(p))»
-                 «FOR i : p.instances.filter[target == fInterface]»
-                     CommonAPI::DBus::DBusAddressTranslator::get()->insert(
-                         "local:«fInterface.fullyQualifiedNameWithVersion»:«providerAccessor.getInstanceId(i)»",
-                         "«providerAccessor.getDBusServiceName(i)»",
-                         "«providerAccessor.getDBusObjectPath(i)»",
-                         "«providerAccessor.getDBusInterfaceName(i)»");
-                 «ENDFOR»
-             «ENDFOR»
+            «fInterface.generateDBusAddressTable(providers)»
             CommonAPI::DBus::Factory::get()->registerStubAdapterCreateMethod(
                 «fInterface.elementName»::getInterface(), &create«fInterface.dbusStubAdapterClassName»);
         }
@@ -751,12 +1181,292 @@ class FInterfaceDBusStubAdapterGenerator {
 
         «fInterface.model.generateNamespaceEndDeclaration»
         «fInterface.generateVersionNamespaceEnd»
+        «IF generateExplicitInstantiation»
+
+            «fInterface.generateStubAdapterInstantiations("template class")»
+        «ENDIF»
     '''
 
-    def dbusDispatcherTableEntry(FInterface fInterface, String methodName, String dbusSignature, String memberFunctionName) '''
-        «fInterface.dbusStubAdapterHelperClassName»::addStubDispatcher({ "«methodName»", "«dbusSignature»" }, &«memberFunctionName»);
+    // The introspection data of the whole inheritance chain is flattened into a
+    // single literal at generation time.
+    def private CharSequence generateIntrospectionXmlData(FInterface fInterface, PropertyAccessor deploymentAccessor) '''
+        «IF fInterface.base != null»
+            «fInterface.base.generateIntrospectionXmlData(fInterface.base.deploymentAccessor)»
+        «ELSE»
+            "<method name=\"getInterfaceVersion\">\n"
+                "<arg name=\"value\" type=\"uu\" direction=\"out\" />"
+            "</method>\n"
+        «ENDIF»
+        «FOR attribute : fInterface.attributes»
+            «IF deploymentAccessor.getPropertiesType(attribute.containingInterface) == PropertyAccessor.PropertiesType.freedesktop»
+                "<property name=\"«attribute.elementName»\" type=\"«attribute.dbusSignature(deploymentAccessor)»\" access=\"read«IF !attribute.readonly»write«ENDIF»\" />\n"
+            «ELSE»
+                "<method name=\"«attribute.dbusGetMethodName»\">\n"
+                "<arg name=\"value\" type=\"«attribute.dbusSignature(deploymentAccessor)»\" direction=\"out\" />"
+                "</method>\n"
+                «IF !attribute.isReadonly»
+                    "<method name=\"«attribute.dbusSetMethodName»\">\n"
+                    "<arg name=\"requestedValue\" type=\"«attribute.dbusSignature(deploymentAccessor)»\" direction=\"in\" />\n"
+                    "<arg name=\"setValue\" type=\"«attribute.dbusSignature(deploymentAccessor)»\" direction=\"out\" />\n"
+                    "</method>\n"
+                «ENDIF»
+                «IF attribute.isObservable»
+                    "<signal name=\"«attribute.dbusSignalName»\">\n"
+                    "<arg name=\"changedValue\" type=\"«attribute.dbusSignature(deploymentAccessor)»\" />\n"
+                    "</signal>\n"
+                «ENDIF»
+            «ENDIF»
+        «ENDFOR»
+        «FOR broadcast : fInterface.broadcasts»
+            «IF !broadcast.isErrorType(deploymentAccessor)»
+                «FTypeGenerator::generateComments(broadcast, false)»
+                "<signal name=\"«broadcast.elementName»\">\n"
+                «FOR outArg : broadcast.outArgs»
+                    "<arg name=\"«outArg.elementName»\" type=\"«outArg.getTypeDbusSignature(deploymentAccessor)»\" />\n"
+                «ENDFOR»
+                "</signal>\n"
+            «ENDIF»
+        «ENDFOR»
+        «FOR method : fInterface.methods»
+            «FTypeGenerator::generateComments(method, false)»
+            "<method name=\"«method.elementName»\">\n"
+            «FOR inArg : method.inArgs»
+                "<arg name=\"_«inArg.elementName»\" type=\"«inArg.getTypeDbusSignature(deploymentAccessor)»\" direction=\"in\" />\n"
+            «ENDFOR»
+            «IF method.hasError»
+                "<arg name=\"_error\" type=\"«method.dbusErrorSignature(deploymentAccessor)»\" direction=\"out\" />\n"
+            «ENDIF»
+            «FOR outArg : method.outArgs»
+                "<arg name=\"_«outArg.elementName»\" type=\"«outArg.getTypeDbusSignature(deploymentAccessor)»\" direction=\"out\" />\n"
+            «ENDFOR»
+            "</method>\n"
+        «ENDFOR»
     '''
 
+    def private getDeploymentAccessor(FInterface fInterface) {
+        val PropertyAccessor accessor = getAccessor(fInterface)
+        if (accessor != null) {
+            return accessor
+        }
+        return new PropertyAccessor()
+    }
+
+    def private generateStaticDispatch(FInterface fInterface, PropertyAccessor deploymentAccessor, HashMap<FMethod, Integer> methodnumberMap) '''
+        «val dispatchers = fInterface.getStubDispatcherEntriesByLength(deploymentAccessor, methodnumberMap)»
+        virtual bool onInterfaceDBusMessage(const CommonAPI::DBus::DBusMessage& dbusMessage) {
+            const char* itsMember = dbusMessage.getMember();
+            const char* itsSignature = dbusMessage.getSignature();
+            if (itsMember != nullptr && itsSignature != nullptr) {
+                // Dispatch on the member name length first, then compare the
+                // remaining candidates against their compile-time literals.
+                switch (std::strlen(itsMember)) {
+                «FOR length : dispatchers.keySet»
+                    case «length»:
+                        «FOR entry : dispatchers.get(length)»
+                            if (std::strcmp(itsMember, "«entry.get(0)»") == 0 && std::strcmp(itsSignature, "«entry.get(1)»") == 0) {
+                                return «entry.get(2)».dispatchDBusMessage(dbusMessage,
+                                    «fInterface.dbusStubAdapterHelperClassName»::stub_,
+                                    «fInterface.dbusStubAdapterHelperClassName»::getRemoteEventHandler(),
+                                    «fInterface.dbusStubAdapterHelperClassName»::connection_);
+                            }
+                        «ENDFOR»
+                        break;
+                «ENDFOR»
+                default:
+                    break;
+                }
+            }
+            «IF fInterface.base != null»
+                return «fInterface.base.getTypeCollectionName(fInterface)»DBusStubAdapterInternal<_Stub, _Stubs...>::onInterfaceDBusMessage(dbusMessage);
+            «ELSE»
+                return «fInterface.dbusStubAdapterHelperClassName»::onInterfaceDBusMessage(dbusMessage);
+            «ENDIF»
+        }
+    '''
+
+    def private getStubDispatcherEntries(FInterface fInterface, PropertyAccessor deploymentAccessor, HashMap<FMethod, Integer> methodnumberMap) {
+        val entries = new LinkedList<List<String>>()
+        entries.add(#["getInterfaceVersion", "", "get" + fInterface.elementName + "InterfaceVersionStubDispatcher"])
+        if (deploymentAccessor.getPropertiesType(fInterface) != PropertyAccessor.PropertiesType.freedesktop) {
+            for (attribute : fInterface.attributes) {
+                entries.add(#[attribute.dbusGetMethodName, "", attribute.dbusGetStubDispatcherVariable])
+                if (!attribute.isReadonly) {
+                    entries.add(#[attribute.dbusSetMethodName, attribute.dbusSignature(deploymentAccessor), attribute.dbusSetStubDispatcherVariable])
+                }
+            }
+        }
+        for (method : fInterface.methods) {
+            var dispatcher = method.dbusStubDispatcherVariable
+            if (methodnumberMap.get(method) != 0) {
+                dispatcher = dispatcher + methodnumberMap.get(method)
+            }
+            entries.add(#[method.elementName, method.dbusInSignature(deploymentAccessor), dispatcher])
+        }
+        for (broadcast : fInterface.broadcasts.filter[selective]) {
+            entries.add(#[broadcast.subscribeSelectiveMethodName, "", broadcast.dbusStubDispatcherVariableSubscribe])
+            entries.add(#[broadcast.unsubscribeSelectiveMethodName, "", broadcast.dbusStubDispatcherVariableUnsubscribe])
+        }
+        return entries
+    }
+
+    def private getStubDispatcherEntriesByLength(FInterface fInterface, PropertyAccessor deploymentAccessor, HashMap<FMethod, Integer> methodnumberMap) {
+        // Group by member name length, the first level of the generated switch
+        val dispatchers = new TreeMap<Integer, List<List<String>>>()
+        for (entry : fInterface.getStubDispatcherEntries(deploymentAccessor, methodnumberMap)) {
+            val length = entry.get(0).length
+            if (!dispatchers.containsKey(length)) {
+                dispatchers.put(length, new LinkedList<List<String>>())
+            }
+            dispatchers.get(length).add(entry)
+        }
+        return dispatchers
+    }
+
+    def private generateTableDispatch(FInterface fInterface, PropertyAccessor deploymentAccessor, HashMap<FMethod, Integer> methodnumberMap) '''
+        virtual bool onInterfaceDBusMessage(const CommonAPI::DBus::DBusMessage& dbusMessage) {
+            // Built on first use and shared by all adapters of this type.
+            static const std::unordered_map<
+                CommonAPI::DBus::DBusInterfaceMemberPath,
+                CommonAPI::DBus::StubDispatcher<«fInterface.stubFullClassName»>*
+            > itsDispatchers = {
+                «FOR entry : fInterface.getStubDispatcherEntries(deploymentAccessor, methodnumberMap) SEPARATOR ','»
+                    { { "«entry.get(0)»", "«entry.get(1)»" }, &«entry.get(2)» }
+                «ENDFOR»
+            };
+
+            const char* itsMember = dbusMessage.getMember();
+            const char* itsSignature = dbusMessage.getSignature();
+            if (itsMember != nullptr && itsSignature != nullptr) {
+                auto itsDispatcher = itsDispatchers.find(CommonAPI::DBus::DBusInterfaceMemberPath(itsMember, itsSignature));
+                if (itsDispatcher != itsDispatchers.end()) {
+                    return itsDispatcher->second->dispatchDBusMessage(dbusMessage,
+                        «fInterface.dbusStubAdapterHelperClassName»::stub_,
+                        «fInterface.dbusStubAdapterHelperClassName»::getRemoteEventHandler(),
+                        «fInterface.dbusStubAdapterHelperClassName»::connection_);
+                }
+            }
+            «IF fInterface.base != null»
+                return «fInterface.base.getTypeCollectionName(fInterface)»DBusStubAdapterInternal<_Stub, _Stubs...>::onInterfaceDBusMessage(dbusMessage);
+            «ELSE»
+                return «fInterface.dbusStubAdapterHelperClassName»::onInterfaceDBusMessage(dbusMessage);
+            «ENDIF»
+        }
+    '''
+
+    // The properties of all freedesktop levels of the interface are dispatched by the most
+    // derived adapter, the dispatcher of each property is selected when generating it.
+    def private generateFreedesktopPropertiesDispatch(FInterface fInterface, PropertyAccessor deploymentAccessor) '''
+        «val properties = fInterface.getFreedesktopAttributes(deploymentAccessor)»
+        virtual bool onInterfaceDBusFreedesktopPropertiesMessage(const CommonAPI::DBus::DBusMessage& dbusMessage) {
+            static const std::unordered_map<std::string, std::size_t> itsProperties = {
+                «FOR property : properties.keySet SEPARATOR ','»
+                    { "«property.elementName»", «properties.keySet.toList.indexOf(property)» }
+                «ENDFOR»
+            };
+
+            if (!«fInterface.dbusStubAdapterHelperClassName»::stub_) {
+                return false;
+            }
+
+            CommonAPI::DBus::DBusInputStream itsInput(dbusMessage);
+            std::string itsInterfaceName;
+            itsInput >> itsInterfaceName;
+            if (itsInput.hasError()) {
+                return false;
+            }
+
+            if (dbusMessage.hasMemberName("GetAll")) {
+                CommonAPI::DBus::DBusMessage itsReply = dbusMessage.createMethodReturn("a{sv}");
+                CommonAPI::DBus::DBusOutputStream itsOutput(itsReply);
+                std::shared_ptr<CommonAPI::DBus::DBusClientId> itsClient
+                    = std::make_shared<CommonAPI::DBus::DBusClientId>(std::string(dbusMessage.getSender()));
+
+                itsOutput.beginWriteMap();
+                «FOR property : properties.keySet»
+                    itsOutput.align(8);
+                    itsOutput << std::string("«property.elementName»");
+                    «properties.get(property).getLevelMemberName(property.dbusGetStubDispatcherVariable)».dispatchDBusMessageAndAppendReply(
+                        dbusMessage, «fInterface.dbusStubAdapterHelperClassName»::stub_, itsOutput, itsClient);
+                «ENDFOR»
+                itsOutput.endWriteMap();
+                itsOutput.flush();
+                return «fInterface.dbusStubAdapterHelperClassName»::connection_->sendDBusMessage(itsReply);
+            }
+
+            std::string itsPropertyName;
+            itsInput >> itsPropertyName;
+            if (itsInput.hasError()) {
+                return false;
+            }
+            auto itsProperty = itsProperties.find(itsPropertyName);
+            if (itsProperty == itsProperties.end()) {
+                return false;
+            }
+
+            if (dbusMessage.hasMemberName("Get")) {
+                switch (itsProperty->second) {
+                «FOR property : properties.keySet»
+                    case «properties.keySet.toList.indexOf(property)»:
+                        return «properties.get(property).getLevelMemberName(property.dbusGetStubDispatcherVariable)».dispatchDBusMessage(dbusMessage,
+                            «fInterface.dbusStubAdapterHelperClassName»::stub_,
+                            «fInterface.dbusStubAdapterHelperClassName»::getRemoteEventHandler(),
+                            «fInterface.dbusStubAdapterHelperClassName»::connection_);
+                «ENDFOR»
+                default:
+                    break;
+                }
+            } else if (dbusMessage.hasMemberName("Set")) {
+                switch (itsProperty->second) {
+                «FOR property : properties.keySet.filter[!readonly]»
+                    case «properties.keySet.toList.indexOf(property)»:
+                        return «properties.get(property).getLevelMemberName(property.dbusSetStubDispatcherVariable)».dispatchDBusMessage(dbusMessage,
+                            «fInterface.dbusStubAdapterHelperClassName»::stub_,
+                            «fInterface.dbusStubAdapterHelperClassName»::getRemoteEventHandler(),
+                            «fInterface.dbusStubAdapterHelperClassName»::connection_);
+                «ENDFOR»
+                default:
+                    break;
+                }
+            }
+            return false;
+        }
+    '''
+
+    // Maps the attributes of all freedesktop levels of the interface, base levels first,
+    // to the level whose adapter declares their dispatchers.
+    def private getFreedesktopAttributes(FInterface fInterface, PropertyAccessor deploymentAccessor) {
+        val attributes = new LinkedHashMap<FAttribute, FInterface>()
+        for (itsInterface : fInterface.interfaceChain.reverseView) {
+            if (itsInterface.isFreedesktopLevel(fInterface, deploymentAccessor)) {
+                for (attribute : itsInterface.attributes) {
+                    attributes.put(attribute, itsInterface)
+                }
+            }
+        }
+        return attributes
+    }
+
+    def private boolean hasFreedesktopAttributes(FInterface fInterface, PropertyAccessor deploymentAccessor) {
+        return !fInterface.getFreedesktopAttributes(deploymentAccessor).empty
+    }
+
+    // The deployment accessor of a level of the interface chain of fInterface
+    def private PropertyAccessor getLevelAccessor(FInterface _level, FInterface fInterface, PropertyAccessor deploymentAccessor) {
+        if (_level == fInterface) {
+            return deploymentAccessor
+        }
+        return _level.deploymentAccessor
+    }
+
+    def private boolean isFreedesktopLevel(FInterface _level, FInterface fInterface, PropertyAccessor deploymentAccessor) {
+        return _level.getLevelAccessor(fInterface, deploymentAccessor).getPropertiesType(_level) == PropertyAccessor.PropertiesType.freedesktop
+    }
+
+    // The qualified name of a member of the adapter of a level of the interface chain
+    def private getLevelMemberName(FInterface _level, String _member) {
+        _level.absoluteNamespace + "::" + _level.dbusStubAdapterClassNameInternal + "<_Stub, _Stubs...>::" + _member
+    }
+
     def private getAbsoluteNamespace(FModelElement fModelElement) {
         fModelElement.model.name.replace('.', '::')
     }
@@ -769,14 +1479,6 @@ class FInterfaceDBusStubAdapterGenerator {
         fInterface.versionPathPrefix + fInterface.model.directoryPath + '/' + fInterface.dbusStubAdapterHeaderFile
     }
 
-    def private dbusStubAdapterSourceFile(FInterface fInterface) {
-        fInterface.elementName + "DBusStubAdapter.cpp"
-    }
-
-    def private dbusStubAdapterSourcePath(FInterface fInterface) {
-        fInterface.versionPathPrefix + fInterface.model.directoryPath + '/' + fInterface.dbusStubAdapterSourceFile
-    }
-
     def private dbusStubAdapterClassName(FInterface fInterface) {
         fInterface.elementName + 'DBusStubAdapter'
     }
@@ -805,6 +1507,10 @@ class FInterfaceDBusStubAdapterGenerator {
         return types
     }
 
+    def private stubManagedAdaptersName(FInterface fInterface) {
+        fInterface.elementName.toFirstLower + 'StubAdapters_'
+    }
+
     def private dbusStubDispatcherVariable(FMethod fMethod) {
         fMethod.elementName.toFirstLower + 'StubDispatcher'
     }
@@ -879,21 +1585,166 @@ class FInterfaceDBusStubAdapterGenerator {
         «ENDIF»
     '''
 
-    def private generateStubAttributeTableInitializer(FInterface fInterface, PropertyAccessor deploymentAccessor) '''
-        «IF deploymentAccessor.getPropertiesType(fInterface) == PropertyAccessor.PropertiesType.freedesktop && !fInterface.attributes.empty»
-            «FOR attribute : fInterface.attributes»
-                «fInterface.generateStubAttributeTableInitializerEntry(attribute)»
-            «ENDFOR»
+    // Selective broadcasts are marshalled once and the body is copied for every receiver.
+    // Unix file descriptors are transferred out of band and can not be copied that way.
+    def private boolean hasSelectiveFanOut(FBroadcast fBroadcast, PropertyAccessor deploymentAccessor) {
+        return fBroadcast.selective && !fBroadcast.dbusSignature(deploymentAccessor).contains("h")
+    }
+
+    def private boolean hasSelectiveFanOut(FInterface fInterface, PropertyAccessor deploymentAccessor) {
+        return fInterface.broadcasts.exists[hasSelectiveFanOut(deploymentAccessor)]
+    }
+
+    def private generateAttributeBatchDefinitions(FInterface fInterface, PropertyAccessor deploymentAccessor) '''
+        «val attributes = fInterface.getBatchedAttributes»
+        «val batchedTypes = fInterface.getBatchedPropertyTypes(deploymentAccessor)»
+        «IF fInterface.base == null»
+            template <typename _Stub, typename... _Stubs>
+            void «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::beginAttributeBatch() {
+                std::lock_guard<std::mutex> itsLock(attributeBatchMutex_);
+                attributeBatchDepth_++;
+            }
+
         «ENDIF»
+        template <typename _Stub, typename... _Stubs>
+        void «fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::commitAttributeBatch() {
+            «IF !batchedTypes.empty»
+                typedef CommonAPI::Variant<
+                    «batchedTypes.keySet.join(',
+')»
+                > PropertyValue_t;
+                typedef CommonAPI::DBus::VariantDeployment<
+                    «batchedTypes.values.map[getDeploymentType(fInterface, true)].join(',
+')»
+                > PropertyValueDeployment_t;
+                typedef CommonAPI::MapDeployment<
+                    CommonAPI::EmptyDeployment,
+                    PropertyValueDeployment_t
+                > PropertiesDeployment_t;
+
+                std::unordered_map<std::string, PropertyValue_t> itsChangedProperties;
+            «ENDIF»
+            «FOR attribute : attributes.keySet»
+                «IF !attribute.isBatchedProperty(fInterface, deploymentAccessor, batchedTypes)»
+                    bool «attribute.attributeBatchPendingLocalName»(false);
+                    «attribute.getTypeName(fInterface, true)» «attribute.attributeBatchValueLocalName»;
+                «ENDIF»
+            «ENDFOR»
+            {
+                std::lock_guard<std::mutex> itsLock(this->attributeBatchMutex_);
+                if (this->attributeBatchDepth_ == 0 || --this->attributeBatchDepth_ > 0) {
+                    return;
+                }
+                «FOR attribute : attributes.keySet»
+                    «val level = attributes.get(attribute)»
+                    if («level.getLevelMemberName(attribute.attributeBatchPendingName)») {
+                        «IF attribute.isBatchedProperty(fInterface, deploymentAccessor, batchedTypes)»
+                            itsChangedProperties["«attribute.elementName»"] = «level.getLevelMemberName(attribute.attributeBatchValueName)»;
+                        «ELSE»
+                            «attribute.attributeBatchPendingLocalName» = true;
+                            «attribute.attributeBatchValueLocalName» = «level.getLevelMemberName(attribute.attributeBatchValueName)»;
+                        «ENDIF»
+                        «level.getLevelMemberName(attribute.attributeBatchPendingName)» = false;
+                    }
+                «ENDFOR»
+            }
+            «IF !batchedTypes.empty»
+
+                if (!itsChangedProperties.empty()) {
+                    PropertyValueDeployment_t itsValueDeployment(true,
+                        «batchedTypes.values.map[getDeploymentRef(array, null, containingInterface, containingInterface.getLevelAccessor(fInterface, deploymentAccessor))].join(',
+')»);
+                    PropertiesDeployment_t itsDeployment(nullptr, &itsValueDeployment);
+                    CommonAPI::Deployable<std::unordered_map<std::string, PropertyValue_t>, PropertiesDeployment_t> deployedProperties(itsChangedProperties, &itsDeployment);
+                    std::vector<std::string> itsInvalidatedProperties;
+
+                    CommonAPI::DBus::DBusStubSignalHelper<CommonAPI::DBus::DBusSerializableArguments<
+                        std::string,
+                        CommonAPI::Deployable<std::unordered_map<std::string, PropertyValue_t>, PropertiesDeployment_t>,
+                        std::vector<std::string>
+                    >>::sendSignal(
+                            «fInterface.dbusStubAdapterHelperClassName»::getDBusAddress().getObjectPath().c_str(),
+                            "org.freedesktop.DBus.Properties",
+                            "PropertiesChanged",
+                            "sa{sv}as",
+                            «fInterface.dbusStubAdapterHelperClassName»::getDBusConnection(),
+                            «fInterface.dbusStubAdapterHelperClassName»::getDBusAddress().getInterface(),
+                            deployedProperties,
+                            itsInvalidatedProperties
+                    );
+                }
+            «ENDIF»
+            «FOR attribute : attributes.keySet»
+                «IF !attribute.isBatchedProperty(fInterface, deploymentAccessor, batchedTypes)»
+                    if («attribute.attributeBatchPendingLocalName») {
+                        «attributes.get(attribute).getLevelMemberName(attribute.stubAdapterClassFireChangedMethodName)»(«attribute.attributeBatchValueLocalName»);
+                    }
+                «ENDIF»
+            «ENDFOR»
+        }
     '''
 
-    def private generateStubAttributeTableInitializerEntry(FInterface fInterface, FAttribute fAttribute) '''
-        «fInterface.dbusStubAdapterHelperClassName»::addAttributeDispatcher("«fAttribute.elementName»",
-                &«fInterface.absoluteNamespace»::«fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«fAttribute.dbusGetStubDispatcherVariable»,
-                «IF fAttribute.readonly»(CommonAPI::DBus::DBusSetFreedesktopAttributeStubDispatcher<«fInterface.stubFullClassName», int>*)NULL«ELSE»&«fInterface.absoluteNamespace»::«fInterface.dbusStubAdapterClassNameInternal»<_Stub, _Stubs...>::«fAttribute.dbusSetStubDispatcherVariable»«ENDIF»
-            );
-    '''
-    
+    // The observable attributes of the interface and its base interfaces, base
+    // interfaces first, mapped to the level whose adapter holds their batch state.
+    def private getBatchedAttributes(FInterface fInterface) {
+        val attributes = new LinkedHashMap<FAttribute, FInterface>()
+        for (itsInterface : fInterface.interfaceChain.reverseView) {
+            for (attribute : itsInterface.attributes.filter[isObservable()]) {
+                attributes.put(attribute, itsInterface)
+            }
+        }
+        return attributes
+    }
+
+    // One variant alternative per distinct C++ type of the observable freedesktop attributes.
+    // The first attribute of a type determines the deployment used for that alternative.
+    def private getBatchedPropertyTypes(FInterface fInterface, PropertyAccessor deploymentAccessor) {
+        val types = new LinkedHashMap<String, FAttribute>()
+        val attributes = fInterface.getBatchedAttributes
+        for (attribute : attributes.keySet) {
+            if (attributes.get(attribute).isFreedesktopLevel(fInterface, deploymentAccessor)) {
+                val typeName = attribute.getTypeName(fInterface, true)
+                if (!types.containsKey(typeName)) {
+                    types.put(typeName, attribute)
+                }
+            }
+        }
+        return types
+    }
+
+    def private boolean hasBatchedProperties(FInterface fInterface, PropertyAccessor deploymentAccessor) {
+        return generateAttributeBatch && !fInterface.getBatchedPropertyTypes(deploymentAccessor).empty
+    }
+
+    // Attributes sharing a C++ type with a different deployment cannot be coalesced,
+    // they are sent with a separate signal on commit.
+    def private isBatchedProperty(FAttribute fAttribute, FInterface fInterface, PropertyAccessor deploymentAccessor, LinkedHashMap<String, FAttribute> batchedTypes) {
+        val level = fAttribute.containingInterface
+        if (!level.isFreedesktopLevel(fInterface, deploymentAccessor)) {
+            return false
+        }
+        val representative = batchedTypes.get(fAttribute.getTypeName(fInterface, true))
+        val representativeLevel = representative.containingInterface
+        return representative.getDeploymentRef(representative.array, null, representativeLevel, representativeLevel.getLevelAccessor(fInterface, deploymentAccessor))
+            == fAttribute.getDeploymentRef(fAttribute.array, null, level, level.getLevelAccessor(fInterface, deploymentAccessor))
+    }
+
+    def private attributeBatchPendingName(FAttribute fAttribute) {
+        fAttribute.elementName.toFirstLower + 'BatchPending_'
+    }
+
+    def private attributeBatchValueName(FAttribute fAttribute) {
+        fAttribute.elementName.toFirstLower + 'BatchValue_'
+    }
+
+    def private attributeBatchPendingLocalName(FAttribute fAttribute) {
+        'its' + fAttribute.elementName.toFirstUpper + 'Pending'
+    }
+
+    def private attributeBatchValueLocalName(FAttribute fAttribute) {
+        'its' + fAttribute.elementName.toFirstUpper + 'Value'
+    }
+
     def private generateErrorReplyCallback(FBroadcast fBroadcast, FInterface fInterface, FMethod fMethod, PropertyAccessor deploymentAccessor) '''
             
         static void «fBroadcast.errorReplyCallbackName(deploymentAccessor)»(«fBroadcast.generateErrorReplyCallbackSignature(fMethod, deploymentAccessor)») {
@@ -63,6 +63,7 @@ class FTypeCollectionDBusDeploymentGenerator {
         #endif
         #include <CommonAPI/DBus/DBusDeployment.hpp>
         #undef COMMONAPI_INTERNAL_COMPILATION
+        «_tc.types.generateWireLayoutIncludes(_accessor)»
 
         «_tc.generateVersionNamespaceBegin»
         «_tc.model.generateNamespaceBeginDeclaration»
@@ -80,6 +81,11 @@ class FTypeCollectionDBusDeploymentGenerator {
             «t.generateDeploymentDeclaration(_tc, _accessor)»
         «ENDFOR»
 
+        // typecollection-specific wire layouts
+        «FOR t: _tc.types»
+            «t.generateWireLayout(_accessor)»
+        «ENDFOR»
+
         «_tc.generateDeploymentNamespaceEnd»
         «_tc.model.generateNamespaceEndDeclaration»
         «_tc.generateVersionNamespaceEnd»
@@ -221,6 +227,60 @@ class FTypeCollectionDBusDeploymentGenerator {
         return generateIndent(_indent) + "CommonAPI::EmptyDeployment"
     }
 
+    /////////////////////////////////////
+    // Generate wire layouts           //
+    /////////////////////////////////////
+    def protected String generateWireLayoutIncludes(List<? extends FType> _types, PropertyAccessor _accessor) {
+        if (!_types.exists[it instanceof FStructType && (it as FStructType).isDBusFixedSize(_accessor)])
+            return ""
+
+        return '''
+
+            #include <cstddef>
+            #include <cstdint>
+            #include <cstring>
+            #include <type_traits>
+        '''
+    }
+
+    def protected String generateWireLayout(FType _type, PropertyAccessor _accessor) {
+        if (!(_type instanceof FStructType) || !(_type as FStructType).isDBusFixedSize(_accessor))
+            return ""
+
+        val FStructType structType = _type as FStructType
+        val List<FField> elements = structType.allElements
+        val List<Integer> offsets = elements.dbusFixedSizeOffsets(_accessor)
+        return '''
+            // D-Bus wire layout of «structType.elementName» («elements.map[getTypeDbusSignature(_accessor)].join»), counted from its 8 byte
+            // aligned start. write() leaves the padding untouched.
+            struct «structType.elementName»Layout_t {
+                static constexpr std::size_t alignment = 8;
+                static constexpr std::size_t size = «offsets.last»;
+
+                template<class _Struct>
+                static void write(char *_body, const _Struct &_value) {
+                    «FOR i : 0 ..< elements.size»
+                        «val e = elements.get(i)»
+                        «val signature = e.getTypeDbusSignature(_accessor)»
+                        const «signature.dbusFixedSizeWireType» wire_«e.elementName» = static_cast< «signature.dbusFixedSizeWireType» >(_value.get«e.elementName.toFirstUpper»());
+                        std::memcpy(_body + «offsets.get(i)», &wire_«e.elementName», «signature.dbusFixedSize»);
+                    «ENDFOR»
+                }
+
+                template<class _Struct>
+                static void read(const char *_body, _Struct &_value) {
+                    «FOR i : 0 ..< elements.size»
+                        «val e = elements.get(i)»
+                        «val signature = e.getTypeDbusSignature(_accessor)»
+                        «signature.dbusFixedSizeWireType» wire_«e.elementName»;
+                        std::memcpy(&wire_«e.elementName», _body + «offsets.get(i)», «signature.dbusFixedSize»);
+                        _value.set«e.elementName.toFirstUpper»(static_cast< typename std::decay<decltype(_value.get«e.elementName.toFirstUpper»())>::type >(wire_«e.elementName»));
+                    «ENDFOR»
+                }
+            };
+        '''
+    }
+
     /////////////////////////////////////
     // Generate deployment declarations //
     /////////////////////////////////////
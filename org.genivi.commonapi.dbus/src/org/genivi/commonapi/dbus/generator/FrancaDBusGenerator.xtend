@@ -5,16 +5,32 @@
 package org.genivi.commonapi.dbus.generator
 
 import java.io.File
+import java.nio.charset.StandardCharsets
+import java.security.MessageDigest
+import java.util.ArrayList
+import java.util.HashMap
 import java.util.HashSet
+import java.util.LinkedHashSet
 import java.util.LinkedList
 import java.util.List
 import java.util.Map
 import java.util.Set
+import java.util.TreeMap
+import java.util.concurrent.Callable
+import java.util.concurrent.ExecutionException
+import java.util.concurrent.ExecutorService
+import java.util.concurrent.Executors
+import java.util.concurrent.Future
 import javax.inject.Inject
+import javax.inject.Provider
 import org.eclipse.core.resources.IResource
+import org.eclipse.emf.ecore.EObject
 import org.eclipse.emf.ecore.resource.Resource
+import org.eclipse.emf.ecore.util.EcoreUtil
+import org.eclipse.xtext.generator.AbstractFileSystemAccess
 import org.eclipse.xtext.generator.IFileSystemAccess
 import org.eclipse.xtext.generator.IGenerator
+import org.eclipse.xtext.generator.OutputConfiguration
 import org.franca.core.dsl.FrancaPersistenceManager
 import org.franca.core.franca.FInterface
 import org.franca.core.franca.FModel
@@ -35,9 +51,13 @@ import org.genivi.commonapi.dbus.preferences.PreferenceConstantsDBus
 class FrancaDBusGenerator implements IGenerator {
     @Inject private extension FrancaGeneratorExtensions
     @Inject private extension FrancaDBusGeneratorExtensions
-    @Inject private extension FInterfaceDBusProxyGenerator
-    @Inject private extension FInterfaceDBusStubAdapterGenerator
-    @Inject private extension FInterfaceDBusDeploymentGenerator
+
+    // The generators keep state while generating a file, so every interface
+    // and type collection gets its own instances.
+    @Inject private Provider<FInterfaceDBusProxyGenerator> proxyGenerator_
+    @Inject private Provider<FInterfaceDBusStubAdapterGenerator> stubAdapterGenerator_
+    @Inject private Provider<FInterfaceDBusDeploymentGenerator> deploymentGenerator_
+    @Inject private Provider<FInterfaceDBusStatisticsGenerator> statisticsGenerator_
 
     @Inject private FrancaPersistenceManager francaPersistenceManager
     @Inject private FDeployManager fDeployManager
@@ -183,14 +203,37 @@ class FrancaDBusGenerator implements IGenerator {
             }
         }
 
-        if (rootModel instanceof FDModel) {
-            doGenerateDeployment(rootModel, deployments, models,
-                deployedInterfaces, deployedTypeCollections, deployedProviders,
-                fileSystemAccess, res, true)
-        } else if (rootModel instanceof FModel) {
-            doGenerateModel(rootModel, models,
-                deployedInterfaces, deployedTypeCollections, deployedProviders,
-                fileSystemAccess, res)
+        setupIncrementalGeneration(fileSystemAccess)
+
+        val int jobs = getGeneratorJobs()
+        if (jobs > 1) {
+            // Resolve all cross references up front, the worker threads must
+            // only read the models.
+            models.values.filterNull.forEach[EcoreUtil.resolveAll(it)]
+            deployments.values.filterNull.forEach[EcoreUtil.resolveAll(it)]
+            executor_ = Executors.newFixedThreadPool(jobs)
+        }
+
+        try {
+            if (rootModel instanceof FDModel) {
+                doGenerateDeployment(rootModel, deployments, models,
+                    deployedInterfaces, deployedTypeCollections, deployedProviders,
+                    fileSystemAccess, res, true)
+            } else if (rootModel instanceof FModel) {
+                doGenerateModel(rootModel, models,
+                    deployedInterfaces, deployedTypeCollections, deployedProviders,
+                    fileSystemAccess, res)
+            }
+        } finally {
+            if (executor_ != null) {
+                executor_.shutdownNow
+                executor_ = null
+            }
+            if (cache_ != null) {
+                cache_.save
+                cache_ = null
+            }
+            outputs_ = null
         }
 
         fDeployManager.clearFidlModels
@@ -335,59 +378,278 @@ class FrancaDBusGenerator implements IGenerator {
                                      List<FDProvider> _providers,
                                      IFileSystemAccess _access,
                                      IResource _res) {
-        var interfacesToGenerate = _model.interfaces.toSet
-        var typeCollectionsToGenerate = _model.typeCollections.toSet
+        val List<FTypeCollection> componentsToGenerate = new LinkedList<FTypeCollection>()
+        componentsToGenerate.addAll(_model.typeCollections.toSet)
+        componentsToGenerate.addAll(_model.interfaces.toSet)
+
+        val Map<FTypeCollection, String> hashes = new HashMap<FTypeCollection, String>()
+        if (cache_ != null) {
+            for (component : componentsToGenerate) {
+                hashes.put(component, component.getInputHash(_interfaces, _typeCollections, _providers))
+            }
+            componentsToGenerate.removeAll(componentsToGenerate.filter[
+                cache_.isUpToDate(cacheKey, hashes.get(it))
+            ].toList)
+        }
 
-        typeCollectionsToGenerate.forEach [
-            it.generateTypeCollectionDeployment(_access, getAccessor(it), _res)
-        ]
+        if (executor_ == null || componentsToGenerate.size < 2) {
+            for (component : componentsToGenerate) {
+                val generated = component.generateComponent(_interfaces, _providers, _res)
+                component.flush(generated, _access, hashes.get(component))
+            }
+        } else {
+            // Generate in parallel, but write the files in the same order as
+            // the sequential generation does.
+            val List<Future<DBusBufferedFileSystemAccess>> results = new ArrayList<Future<DBusBufferedFileSystemAccess>>()
+            for (component : componentsToGenerate) {
+                val Callable<DBusBufferedFileSystemAccess> task = [|
+                    component.generateComponent(_interfaces, _providers, _res)
+                ]
+                results.add(executor_.submit(task))
+            }
+            try {
+                for (i : 0 ..< componentsToGenerate.size) {
+                    val component = componentsToGenerate.get(i)
+                    component.flush(results.get(i).get, _access, hashes.get(component))
+                }
+            } catch (ExecutionException e) {
+                throw e.cause
+            } finally {
+                results.forEach[cancel(true)]
+            }
+        }
 
-        interfacesToGenerate.forEach [
-            val currentInterface = it
-            var PropertyAccessor deploymentAccessor = getAccessor(it);
-            if (null == deploymentAccessor) {
-	            if (_interfaces.exists[it.target == currentInterface]) {
-	                deploymentAccessor = new PropertyAccessor(
-	                    new FDeployedInterface(_interfaces.filter[it.target == currentInterface].last))
-	            } else {
-	                deploymentAccessor = new PropertyAccessor()
-	            }
-			}
+        if (FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_CODE_DBUS, "true").
+            equals("true") &&
+            FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_UNITY_DBUS, "false").
+            equals("true")) {
+            _model.generateUnityFile(_access)
+        }
+    }
+
+    // One source file that includes all D-Bus sources generated for a model, so
+    // that they can be compiled as a single translation unit.
+    def private void generateUnityFile(FModel _model, IFileSystemAccess _access) {
+        val List<String> sources = new ArrayList<String>()
+        _model.typeCollections.forEach[sources.add(dbusDeploymentSourcePath)]
+        _model.interfaces.forEach[
             if (FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_PROXY_DBUS, "true").
                 equals("true")) {
-                it.generateDBusProxy(_access, deploymentAccessor, _providers, _res)
+                sources.add(dbusProxySourcePath)
             }
             if (FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_STUB_DBUS, "true").
                 equals("true")) {
-                it.generateDBusStubAdapter(_access, deploymentAccessor, _providers, _res)
+                sources.add(dbusStubAdapterSourcePath)
             }
-
             if (FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_COMMON_DBUS, "true").
                 equals("true")) {
-                it.generateDeployment(_access, deploymentAccessor, _res)
+                sources.add(dbusDeploymentSourcePath)
             }
-            it.managedInterfaces.forEach [
-                val currentManagedInterface = it
-                var PropertyAccessor managedDeploymentAccessor
-                if (_interfaces.exists[it.target == currentManagedInterface]) {
-                    managedDeploymentAccessor = new PropertyAccessor(
-                        new FDeployedInterface(_interfaces.filter[it.target == currentManagedInterface].last))
+        ]
+        if (sources.empty) {
+            return
+        }
+
+        val access = new DBusBufferedFileSystemAccess()
+        access.generateFile(_model.dbusUnitySourcePath, IFileSystemAccess.DEFAULT_OUTPUT,
+            _model.generateUnitySource(sources))
+        access.flushTo(_access, outputs_)
+    }
+
+    def private generateUnitySource(FModel _model, List<String> _sources) '''
+        «generateCommonApiDBusLicenseHeader()»
+        // Compile this file instead of the sources it includes. The output directories
+        // of the generated proxy, stub adapter and common code must be on the include path.
+        «FOR source : _sources»
+            #include <«source»>
+        «ENDFOR»
+    '''
+
+    def private String getDbusUnitySourcePath(FModel _model) {
+        val String fileName = _model.eResource.URI.trimFileExtension.lastSegment
+        return _model.directoryPath + '/' + fileName.split("[^A-Za-z0-9]+").map[toFirstUpper].join + "DBusUnity.cpp"
+    }
+
+    def private DBusBufferedFileSystemAccess generateComponent(FTypeCollection _component,
+                                                               List<FDInterface> _interfaces,
+                                                               List<FDProvider> _providers,
+                                                               IResource _res) {
+        val access = new DBusBufferedFileSystemAccess()
+        if (_component instanceof FInterface) {
+            _component.generateInterface(access, _interfaces, _providers, _res)
+        } else {
+            deploymentGenerator_.get.generateTypeCollectionDeployment(_component, access, getAccessor(_component), _res)
+        }
+        return access
+    }
+
+    def private void generateInterface(FInterface _interface,
+                                       IFileSystemAccess _access,
+                                       List<FDInterface> _interfaces,
+                                       List<FDProvider> _providers,
+                                       IResource _res) {
+        val proxyGenerator = proxyGenerator_.get
+        val stubAdapterGenerator = stubAdapterGenerator_.get
+        val deploymentGenerator = deploymentGenerator_.get
+
+        var PropertyAccessor deploymentAccessor = getAccessor(_interface);
+        if (null == deploymentAccessor) {
+            if (_interfaces.exists[it.target == _interface]) {
+                deploymentAccessor = new PropertyAccessor(
+                    new FDeployedInterface(_interfaces.filter[it.target == _interface].last))
+            } else {
+                deploymentAccessor = new PropertyAccessor()
+            }
+        }
+        if (FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_PROXY_DBUS, "true").
+            equals("true")) {
+            proxyGenerator.generateDBusProxy(_interface, _access, deploymentAccessor, _providers, _res)
+        }
+        if (FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_STUB_DBUS, "true").
+            equals("true")) {
+            stubAdapterGenerator.generateDBusStubAdapter(_interface, _access, deploymentAccessor, _providers, _res)
+        }
+
+        if (FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_COMMON_DBUS, "true").
+            equals("true")) {
+            deploymentGenerator.generateDeployment(_interface, _access, deploymentAccessor, _res)
+            statisticsGenerator_.get.generateStatistics(_interface, _access, deploymentAccessor, _res)
+        }
+        _interface.managedInterfaces.forEach [
+            val currentManagedInterface = it
+            var PropertyAccessor managedDeploymentAccessor
+            if (_interfaces.exists[it.target == currentManagedInterface]) {
+                managedDeploymentAccessor = new PropertyAccessor(
+                    new FDeployedInterface(_interfaces.filter[it.target == currentManagedInterface].last))
+            } else {
+                managedDeploymentAccessor = new PropertyAccessor()
+            }
+
+            if (FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_PROXY_DBUS, "true").
+                equals("true")) {
+                proxyGenerator.generateDBusProxy(it, _access, managedDeploymentAccessor, _providers, _res)
+            }
+            if (FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_STUB_DBUS, "true").
+                equals("true")) {
+                stubAdapterGenerator.generateDBusStubAdapter(it, _access, managedDeploymentAccessor, _providers, _res)
+            }
+        ]
+    }
+
+    def private void flush(FTypeCollection _component, DBusBufferedFileSystemAccess _generated,
+                           IFileSystemAccess _access, String _hash) {
+        val files = _generated.flushTo(_access, outputs_)
+        if (cache_ != null) {
+            cache_.update(_component.cacheKey, _hash, files)
+        }
+    }
+
+    def private int getGeneratorJobs() {
+        try {
+            return Math.max(1, Integer.parseInt(FPreferencesDBus::instance.getPreference(
+                PreferenceConstantsDBus::P_GENERATOR_JOBS_DBUS, "1")))
+        } catch (NumberFormatException e) {
+            return 1
+        }
+    }
+
+    // Incremental generation needs to know where the files end up, which is
+    // only the case for file system accesses with output configurations.
+    def private void setupIncrementalGeneration(IFileSystemAccess _access) {
+        if (FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_INCREMENTAL_DBUS, "false").
+            equals("true") && _access instanceof AbstractFileSystemAccess) {
+            outputs_ = (_access as AbstractFileSystemAccess).outputConfigurations
+            val defaultOutput = outputs_.get(IFileSystemAccess.DEFAULT_OUTPUT)
+            if (defaultOutput != null) {
+                cache_ = new DBusGeneratorCache(new File(defaultOutput.outputDirectory))
+            }
+        }
+    }
+
+    def private String getCacheKey(FTypeCollection _component) {
+        return EcoreUtil.getURI(_component).toString
+    }
+
+    // The hash covers the component, every interface and type collection it
+    // references (directly or indirectly), their deployments, the providers,
+    // the generator preferences and output directories and the generator version.
+    def private String getInputHash(FTypeCollection _component,
+                                    List<FDInterface> _interfaces,
+                                    List<FDTypes> _typeCollections,
+                                    List<FDProvider> _providers) {
+        val digest = MessageDigest.getInstance("SHA-256")
+
+        val Set<FTypeCollection> inputs = new LinkedHashSet<FTypeCollection>()
+        val List<FTypeCollection> pending = new LinkedList<FTypeCollection>()
+        pending.add(_component)
+        while (!pending.empty) {
+            val current = pending.remove(0)
+            if (inputs.add(current)) {
+                digest.addContents(current, pending)
+            }
+        }
+
+        val List<FTypeCollection> ignored = new LinkedList<FTypeCollection>()
+        _interfaces.filter[inputs.contains(target)].forEach[digest.addContents(it, ignored)]
+        _typeCollections.filter[inputs.contains(target)].forEach[digest.addContents(it, ignored)]
+        _providers.forEach[digest.addContents(it, ignored)]
+
+        new TreeMap<String, String>(FPreferencesDBus::instance.preferences).forEach[key, value |
+            digest.add(key + "=" + value)
+        ]
+        if (outputs_ != null) {
+            new TreeMap<String, OutputConfiguration>(outputs_).forEach[key, value |
+                digest.add(key + "=" + value.outputDirectory)
+            ]
+        }
+        digest.add(String.valueOf(getDBusVersion))
+
+        return digest.digest.map[String.format("%02x", it)].join
+    }
+
+    def private void addContents(MessageDigest _digest, EObject _object, List<FTypeCollection> _references) {
+        val List<EObject> contents = new LinkedList<EObject>()
+        contents.add(_object)
+        contents.addAll(_object.eAllContents.toIterable)
+        for (content : contents) {
+            _digest.add(content.eClass.name)
+            for (attribute : content.eClass.EAllAttributes) {
+                _digest.add(String.valueOf(content.eGet(attribute)))
+            }
+            for (reference : content.eClass.EAllReferences.filter[!containment && !container]) {
+                val value = content.eGet(reference)
+                if (value instanceof List<?>) {
+                    value.forEach[_digest.addReference(it, _references)]
                 } else {
-                    managedDeploymentAccessor = new PropertyAccessor()
+                    _digest.addReference(value, _references)
                 }
+            }
+        }
+    }
 
-                if (FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_PROXY_DBUS, "true").
-                    equals("true")) {
-                    it.generateDBusProxy(_access, managedDeploymentAccessor, _providers, _res)
-                }
-                if (FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_STUB_DBUS, "true").
-                    equals("true")) {
-                    it.generateDBusStubAdapter(_access, managedDeploymentAccessor, _providers, _res)
-                }
-            ]
-        ]
+    def private void addReference(MessageDigest _digest, Object _target, List<FTypeCollection> _references) {
+        if (_target instanceof EObject) {
+            _digest.add(EcoreUtil.getURI(_target).toString)
+            var EObject container = _target
+            while (container != null && !(container instanceof FTypeCollection)) {
+                container = container.eContainer
+            }
+            if (container != null) {
+                _references.add(container as FTypeCollection)
+            }
+        } else {
+            _digest.add("null")
+        }
+    }
+
+    def private void add(MessageDigest _digest, String _value) {
+        _digest.update(_value.getBytes(StandardCharsets.UTF_8))
+        _digest.update(0 as byte)
     }
 
     private boolean withDependencies_
     private Set<String> generatedFiles_
+    private ExecutorService executor_
+    private DBusGeneratorCache cache_
+    private Map<String, OutputConfiguration> outputs_
 }
@@ -6,9 +6,11 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 package org.genivi.commonapi.dbus.generator
 
+import java.util.ArrayList
 import java.util.Collection
 import java.util.HashMap
 import java.util.HashSet
+import java.util.List
 import java.util.Map
 import java.util.Set
 import javax.inject.Inject
@@ -31,6 +33,8 @@ import org.franca.core.franca.FTypeDef
 import org.franca.core.franca.FTypeRef
 import org.franca.core.franca.FTypedElement
 import org.franca.core.franca.FUnionType
+import org.franca.deploymodel.core.FDeployedProvider
+import org.franca.deploymodel.dsl.fDeploy.FDProvider
 import org.genivi.commonapi.core.generator.FrancaGeneratorExtensions
 import org.genivi.commonapi.dbus.deployment.PropertyAccessor
 import org.genivi.commonapi.dbus.preferences.FPreferencesDBus
@@ -56,6 +60,43 @@ class FrancaDBusGeneratorExtensions {
         return fInterface.versionPathPrefix + fInterface.model.directoryPath + '/' + fInterface.dbusDeploymentSourceFile
     }
 
+    def String dbusProxySourceFile(FInterface fInterface) {
+        return fInterface.elementName + "DBusProxy.cpp"
+    }
+
+    def String dbusProxySourcePath(FInterface fInterface) {
+        return fInterface.versionPathPrefix + fInterface.model.directoryPath + '/' + fInterface.dbusProxySourceFile
+    }
+
+    def String dbusStubAdapterSourceFile(FInterface fInterface) {
+        return fInterface.elementName + "DBusStubAdapter.cpp"
+    }
+
+    def String dbusStubAdapterSourcePath(FInterface fInterface) {
+        return fInterface.versionPathPrefix + fInterface.model.directoryPath + '/' + fInterface.dbusStubAdapterSourceFile
+    }
+
+    def String dbusStatisticsClassName(FInterface fInterface) {
+        return fInterface.elementName + "DBusStatistics"
+    }
+
+    def String dbusStatisticsHeaderPath(FInterface fInterface) {
+        return fInterface.versionPathPrefix + fInterface.model.directoryPath + '/' + fInterface.dbusStatisticsClassName + ".hpp"
+    }
+
+    // Interfaces without methods have nothing to count. The statistics interface
+    // of the stub adapters needs the statistics.
+    def boolean hasDBusStatistics(FInterface fInterface) {
+        return !fInterface.methods.empty &&
+            (FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_STATISTICS_DBUS, "false").equals("true") ||
+             FPreferencesDBus::instance.getPreference(PreferenceConstantsDBus::P_GENERATE_STATISTICS_INTERFACE_DBUS, "false").equals("true"))
+    }
+
+    // Methods are counted by their position in the interface, which tells overloads apart.
+    def int dbusStatisticsIndex(FMethod fMethod) {
+        return (fMethod.eContainer as FInterface).methods.indexOf(fMethod)
+    }
+
     def dbusInSignature(FMethod fMethod, PropertyAccessor deploymentAccessor) {
         fMethod.inArgs.map[getTypeDbusSignature(deploymentAccessor)].join;
     }
@@ -109,7 +150,9 @@ class FrancaDBusGeneratorExtensions {
     }
 
     def getTypeDbusSignature(FTypedElement element, PropertyAccessor deploymentAccessor) {
-        if (element.array) {
+        if (element.isDBusSharedBuffer(deploymentAccessor)) {
+            return "h"
+        } else if (element.array) {
             return "a" + element.typeDbusSignature(deploymentAccessor)
         } else {
             return element.typeDbusSignature(deploymentAccessor)
@@ -212,6 +255,137 @@ class FrancaDBusGeneratorExtensions {
         }
     }
 
+    /**
+     * Arguments of a fixed size basic type (everything but strings, byte buffers,
+     * arrays and derived types) or of a fixed size struct are written to D-Bus at
+     * a fixed offset.
+     */
+    def boolean isDBusFixedSize(FTypedElement _element, PropertyAccessor _accessor) {
+        if (_element.array)
+            return false
+        if (_element.type.derived != null)
+            return _element.dbusFixedSizeStruct(_accessor) != null
+
+        val signature = _element.getTypeDbusSignature(_accessor)
+        return signature.length == 1 && "ybnqiuxtd".contains(signature)
+    }
+
+    /**
+     * Non-polymorphic structs whose fields are all of a fixed size basic type have a
+     * «Struct»Layout_t in their deployment header that copies them as one run.
+     */
+    def boolean isDBusFixedSize(FStructType _struct, PropertyAccessor _accessor) {
+        return !_struct.isPolymorphic && !_struct.allElements.empty &&
+            _struct.allElements.forall[!array && type.derived == null && isDBusFixedSize(_accessor)]
+    }
+
+    def FStructType dbusFixedSizeStruct(FTypedElement _element, PropertyAccessor _accessor) {
+        if (_element.array || !(_element.type.derived instanceof FStructType))
+            return null
+
+        val FStructType struct = _element.type.derived as FStructType
+        return if (struct.isDBusFixedSize(_accessor)) struct else null
+    }
+
+    def String dbusLayoutName(FStructType _struct) {
+        return (_struct.eContainer as FModelElement).getFullName + "_::" + _struct.elementName + "Layout_t"
+    }
+
+    def boolean isDBusFixedSize(FMethod _method, PropertyAccessor _accessor) {
+        return !_method.hasError && _method.inArgs.forall[isDBusFixedSize(_accessor)] &&
+            _method.outArgs.forall[isDBusFixedSize(_accessor)]
+    }
+
+    /**
+     * Input arguments of type ByteBuffer or UInt8[] that are deployed as DBusSharedBuffer
+     * are transferred as a sealed memfd. Methods with errors keep the in-band transfer,
+     * their replies are sent by the generic stub dispatchers.
+     */
+    def boolean isDBusSharedBuffer(FTypedElement _element, PropertyAccessor _accessor) {
+        if (!(_element instanceof FArgument) || !(_element.eContainer instanceof FMethod))
+            return false
+
+        val FMethod method = _element.eContainer as FMethod
+        if (!method.inArgs.contains(_element) || method.hasError ||
+            (method.eContainer as FInterface).broadcasts.exists[isErrorType(method, _accessor)])
+            return false
+
+        val FBasicTypeId type = _element.type.predefined
+        if (!(type == FBasicTypeId.BYTE_BUFFER && !_element.array) && !(type == FBasicTypeId.UINT8 && _element.array))
+            return false
+
+        return _accessor != null && _accessor.getDBusSharedBuffer(_element as FArgument)
+    }
+
+    def boolean hasDBusSharedBuffers(FMethod _method, PropertyAccessor _accessor) {
+        return _method.inArgs.exists[isDBusSharedBuffer(_accessor)]
+    }
+
+    def boolean hasDBusSharedBuffers(FInterface _interface, PropertyAccessor _accessor) {
+        return _interface.methods.exists[hasDBusSharedBuffers(_accessor)]
+    }
+
+    // Size and alignment of a fixed size D-Bus type are the same.
+    def int dbusFixedSize(String _signature) {
+        switch _signature {
+            case 'y': 1
+            case 'n': 2
+            case 'q': 2
+            case 'b': 4
+            case 'i': 4
+            case 'u': 4
+            case 'x': 8
+            case 't': 8
+            case 'd': 8
+            default: throw new IllegalArgumentException("No fixed size D-Bus type: " + _signature)
+        }
+    }
+
+    // The C++ type a fixed size D-Bus type is transferred as.
+    def String dbusFixedSizeWireType(String _signature) {
+        switch _signature {
+            case 'y': 'uint8_t'
+            case 'n': 'int16_t'
+            case 'q': 'uint16_t'
+            case 'b': 'uint32_t'
+            case 'i': 'int32_t'
+            case 'u': 'uint32_t'
+            case 'x': 'int64_t'
+            case 't': 'uint64_t'
+            case 'd': 'double'
+            default: throw new IllegalArgumentException("No fixed size D-Bus type: " + _signature)
+        }
+    }
+
+    /**
+     * Offsets of the given fixed size arguments or struct fields within a message body
+     * or struct, followed by the length of the body or struct. Structs start at an
+     * 8 byte boundary.
+     */
+    def List<Integer> dbusFixedSizeOffsets(List<? extends FTypedElement> _elements, PropertyAccessor _accessor) {
+        val List<Integer> offsets = new ArrayList<Integer>()
+        var int offset = 0
+        for (element : _elements) {
+            val FStructType struct = element.dbusFixedSizeStruct(_accessor)
+            if (struct != null) {
+                offset = dbusAlign(offset, 8)
+                offsets.add(offset)
+                offset = offset + struct.allElements.dbusFixedSizeOffsets(_accessor).last
+            } else {
+                val int size = element.getTypeDbusSignature(_accessor).dbusFixedSize
+                offset = dbusAlign(offset, size)
+                offsets.add(offset)
+                offset = offset + size
+            }
+        }
+        offsets.add(offset)
+        return offsets
+    }
+
+    def int dbusAlign(int _offset, int _alignment) {
+        return ((_offset + _alignment - 1) / _alignment) * _alignment
+    }
+
     def getDBusVersion() {
         val bundle = FrameworkUtil::getBundle(this.getClass())
         val bundleContext = bundle.getBundleContext();
@@ -222,6 +396,33 @@ class FrancaDBusGeneratorExtensions {
         }
     }
 
+    // The deployment defined addresses of an interface are emitted as a constant
+    // table, which needs no dynamic initialization, and are inserted in one loop.
+    def generateDBusAddressTable(FInterface fInterface, List<FDProvider> providers) '''
+        «IF providers.exists[instances.exists[target == fInterface]]»
+            static const struct {
+                const char *address_;
+                const char *service_;
+                const char *objectPath_;
+                const char *interface_;
+            } itsAddresses[] = {
+                «FOR p : providers»
+                    «val PropertyAccessor providerAccessor = new PropertyAccessor(new FDeployedProvider(p))»
+                    «FOR i : p.instances.filter[target == fInterface]»
+                        { "local:«fInterface.fullyQualifiedNameWithVersion»:«providerAccessor.getInstanceId(i)»",
+                          "«providerAccessor.getDBusServiceName(i)»",
+                          "«providerAccessor.getDBusObjectPath(i)»",
+                          "«providerAccessor.getDBusInterfaceName(i)»" },
+                    «ENDFOR»
+                «ENDFOR»
+            };
+            std::shared_ptr<CommonAPI::DBus::DBusAddressTranslator> itsTranslator = CommonAPI::DBus::DBusAddressTranslator::get();
+            for (const auto &itsAddress : itsAddresses) {
+                itsTranslator->insert(itsAddress.address_, itsAddress.service_, itsAddress.objectPath_, itsAddress.interface_);
+            }
+        «ENDIF»
+    '''
+
     def generateCommonApiDBusLicenseHeader() '''
         /*
         * This file was generated by the CommonAPI Generators.
@@ -84,6 +84,33 @@ public class FPreferencesDBus {
 	        if (!preferences.containsKey(PreferenceConstantsDBus.P_GENERATE_SYNC_CALLS_DBUS)) {
 	            preferences.put(PreferenceConstantsDBus.P_GENERATE_SYNC_CALLS_DBUS, "true");    
 	        }
+	        if (!preferences.containsKey(PreferenceConstantsDBus.P_GENERATE_STATIC_DISPATCH_DBUS)) {
+	            preferences.put(PreferenceConstantsDBus.P_GENERATE_STATIC_DISPATCH_DBUS, "false");
+	        }
+	        if (!preferences.containsKey(PreferenceConstantsDBus.P_GENERATE_COROUTINES_DBUS)) {
+	            preferences.put(PreferenceConstantsDBus.P_GENERATE_COROUTINES_DBUS, "false");
+	        }
+	        if (!preferences.containsKey(PreferenceConstantsDBus.P_GENERATE_EXPLICIT_INSTANTIATION_DBUS)) {
+	            preferences.put(PreferenceConstantsDBus.P_GENERATE_EXPLICIT_INSTANTIATION_DBUS, "false");
+	        }
+	        if (!preferences.containsKey(PreferenceConstantsDBus.P_GENERATE_UNITY_DBUS)) {
+	            preferences.put(PreferenceConstantsDBus.P_GENERATE_UNITY_DBUS, "false");
+	        }
+	        if (!preferences.containsKey(PreferenceConstantsDBus.P_GENERATE_STATISTICS_DBUS)) {
+	            preferences.put(PreferenceConstantsDBus.P_GENERATE_STATISTICS_DBUS, "false");
+	        }
+	        if (!preferences.containsKey(PreferenceConstantsDBus.P_GENERATE_STATISTICS_INTERFACE_DBUS)) {
+	            preferences.put(PreferenceConstantsDBus.P_GENERATE_STATISTICS_INTERFACE_DBUS, "false");
+	        }
+	        if (!preferences.containsKey(PreferenceConstantsDBus.P_GENERATE_ATTRIBUTE_BATCH_DBUS)) {
+	            preferences.put(PreferenceConstantsDBus.P_GENERATE_ATTRIBUTE_BATCH_DBUS, "false");
+	        }
+	        if (!preferences.containsKey(PreferenceConstantsDBus.P_GENERATE_INCREMENTAL_DBUS)) {
+	            preferences.put(PreferenceConstantsDBus.P_GENERATE_INCREMENTAL_DBUS, "false");
+	        }
+	        if (!preferences.containsKey(PreferenceConstantsDBus.P_GENERATOR_JOBS_DBUS)) {
+	            preferences.put(PreferenceConstantsDBus.P_GENERATOR_JOBS_DBUS, "1");
+	        }
 	    }
 
 	    public String getPreference(String preferencename, String defaultValue) {
@@ -23,4 +23,13 @@ public interface PreferenceConstantsDBus extends PreferenceConstants
 	public static final String P_GENERATE_DEPENDENCIES_DBUS = P_GENERATE_DEPENDENCIES;
 	public static final String P_GENERATE_SYNC_CALLS_DBUS = P_GENERATE_SYNC_CALLS;
 	public static final String P_ENABLE_DBUS_VALIDATOR  = "enableDBusValidator";
+	public static final String P_GENERATE_STATIC_DISPATCH_DBUS = "generateStaticDispatchDBus";
+	public static final String P_GENERATE_COROUTINES_DBUS = "generateCoroutinesDBus";
+	public static final String P_GENERATE_EXPLICIT_INSTANTIATION_DBUS = "generateExplicitInstantiationDBus";
+	public static final String P_GENERATE_UNITY_DBUS = "generateUnityDBus";
+	public static final String P_GENERATE_STATISTICS_DBUS = "generateStatisticsDBus";
+	public static final String P_GENERATE_STATISTICS_INTERFACE_DBUS = "generateStatisticsInterfaceDBus";
+	public static final String P_GENERATE_ATTRIBUTE_BATCH_DBUS = "generateAttributeBatchDBus";
+	public static final String P_GENERATE_INCREMENTAL_DBUS = "generateIncrementalDBus";
+	public static final String P_GENERATOR_JOBS_DBUS = "generatorJobsDBus";
 }
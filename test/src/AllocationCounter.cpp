@@ -0,0 +1,47 @@
+// Copyright (C) 2015 Bayerische Motoren Werke Aktiengesellschaft (BMW AG)
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.hpp"
+
+std::atomic<bool> isCountingAllocations(false);
+std::atomic<uint64_t> allocationCount(0);
+
+static void* countingAllocate(std::size_t size) {
+    if (isCountingAllocations) {
+        allocationCount++;
+    }
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new(std::size_t size) {
+    return countingAllocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countingAllocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
@@ -0,0 +1,17 @@
+// Copyright (C) 2015 Bayerische Motoren Werke Aktiengesellschaft (BMW AG)
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __ALLOCATION_COUNTER__
+#define __ALLOCATION_COUNTER__
+
+#include <atomic>
+#include <cstdint>
+
+// Linking AllocationCounter.cpp replaces the global operator new and delete.
+// Every heap allocation of the process is counted while isCountingAllocations is set.
+extern std::atomic<bool> isCountingAllocations;
+extern std::atomic<uint64_t> allocationCount;
+
+#endif // __ALLOCATION_COUNTER__
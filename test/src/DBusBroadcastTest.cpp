@@ -5,8 +5,12 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <functional>
 #include <memory>
@@ -15,6 +19,7 @@
 #include <utility>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 
 #include <CommonAPI/CommonAPI.hpp>
 
@@ -88,11 +93,20 @@ public:
     }
 
 
+    void sendWithOutArgs(uint32_t value, const std::string &payload) {
+        sentBroadcasts++;
+        fireTestBroadcastWithOutArgsSelective(value, payload);
+    }
+
     int getNumberOfSubscribedClients() {
         return static_cast<int>(getSubscribersForTestSelectiveBroadcastSelective()->size());
 
     }
 
+    int getNumberOfSubscribedClientsWithOutArgs() {
+        return static_cast<int>(getSubscribersForTestBroadcastWithOutArgsSelective()->size());
+    }
+
     bool acceptSubs;
 
 private:
@@ -529,6 +543,126 @@ TEST_F(DBusBroadcastTest, ProxysCanSubscribeForSelectiveBroadcast)
 
     proxyFromSameConnection->getTestSelectiveBroadcastSelectiveEvent().unsubscribe(subscriptionResult1);
     EXPECT_EQ(stub->getNumberOfSubscribedClients(), 1);
+
+    // Throughput with many subscribers, each on its own connection. The body of every
+    // event is marshalled once and copied to all receivers.
+    unsigned int numberOfSubscribers = 32;
+    if (const char *subscribers = std::getenv("COMMONAPI_DBUS_BROADCAST_SUBSCRIBERS")) {
+        numberOfSubscribers = static_cast<unsigned int>(std::strtoul(subscribers, nullptr, 10));
+    }
+    const unsigned int numberOfEvents = 100;
+    const std::string payload(4096, 'x');
+
+    std::vector<std::shared_ptr<VERSION::commonapi::tests::TestInterfaceProxy<>>> subscribers;
+    std::vector<CommonAPI::Event<uint32_t, std::string>::Subscription> subscriptions;
+    std::atomic<unsigned int> numberOfSubscriptions(0);
+    std::atomic<unsigned int> numberOfArrivals(0);
+    for (unsigned int i = 0; i < numberOfSubscribers; i++) {
+        auto subscriber = runtime_->buildProxy<VERSION::commonapi::tests::TestInterfaceProxy>(
+                serviceAddressObject_.getDomain(), serviceAddressObject_.getInstance(), "selectiveClient" + std::to_string(i));
+        ASSERT_TRUE((bool)subscriber);
+        for (unsigned int j = 0; !subscriber->isAvailable() && j < 200; ++j) {
+            std::this_thread::sleep_for(std::chrono::microseconds(10000));
+        }
+        ASSERT_TRUE(subscriber->isAvailable());
+
+        subscriptions.push_back(subscriber->getTestBroadcastWithOutArgsSelectiveEvent().subscribe(
+                [&](const uint32_t &, const std::string &) {
+                    numberOfArrivals++;
+                },
+                [&](const CommonAPI::CallStatus _status) {
+                    EXPECT_EQ(CommonAPI::CallStatus::SUCCESS, _status);
+                    numberOfSubscriptions++;
+                }));
+        subscribers.push_back(subscriber);
+    }
+    for (unsigned int i = 0; numberOfSubscriptions < numberOfSubscribers && i < 500; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds(10000));
+    }
+    ASSERT_EQ(numberOfSubscribers, numberOfSubscriptions.load());
+    ASSERT_EQ(static_cast<int>(numberOfSubscribers), stub->getNumberOfSubscribedClientsWithOutArgs());
+
+    const unsigned int expectedArrivals = numberOfSubscribers * numberOfEvents;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < numberOfEvents; i++) {
+        stub->sendWithOutArgs(i, payload);
+    }
+    for (unsigned int i = 0; numberOfArrivals < expectedArrivals && i < 30000; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds(1000));
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    EXPECT_EQ(expectedArrivals, numberOfArrivals.load());
+
+    const double seconds = double(elapsed.count()) / 1000000.0;
+    printf("[ BENCH    ] %u subscribers, %u events of %zu bytes: %.1f events/s, %.1f MB/s delivered\n",
+           numberOfSubscribers, numberOfEvents, payload.size(),
+           numberOfEvents / seconds,
+           double(numberOfArrivals.load()) * double(payload.size()) / seconds / (1024.0 * 1024.0));
+    fflush(stdout);
+
+    for (unsigned int i = 0; i < numberOfSubscribers; i++) {
+        subscribers[i]->getTestBroadcastWithOutArgsSelectiveEvent().unsubscribe(subscriptions[i]);
+    }
+}
+
+TEST_F(DBusBroadcastTest, SelectiveBroadcastCanBeSentWhileSubscriptionsChange) {
+    auto stableProxy = runtime_->buildProxy<VERSION::commonapi::tests::TestInterfaceProxy>(serviceAddressObject_.getDomain(), serviceAddressObject_.getInstance(), connectionIdClient1_);
+    ASSERT_TRUE((bool)stableProxy);
+    auto changingProxy = runtime_->buildProxy<VERSION::commonapi::tests::TestInterfaceProxy>(serviceAddressObject_.getDomain(), serviceAddressObject_.getInstance(), connectionIdClient2_);
+    ASSERT_TRUE((bool)changingProxy);
+
+    auto stub = std::make_shared<SelectiveBroadcastSender>();
+    serviceAddressInterface_ = stub->getStubAdapter()->getInterface();
+
+    bool serviceRegistered = runtime_->registerService(serviceAddressObject_.getDomain(), serviceAddressObject_.getInstance(), stub, connectionIdService_);
+    for (unsigned int i = 0; !serviceRegistered && i < 100; ++i) {
+        serviceRegistered = runtime_->registerService(serviceAddressObject_.getDomain(), serviceAddressObject_.getInstance(), stub, connectionIdService_);
+        std::this_thread::sleep_for(std::chrono::microseconds(10000));
+    }
+    ASSERT_TRUE(serviceRegistered);
+
+    for (unsigned int i = 0; !(stableProxy->isAvailable() && changingProxy->isAvailable()) && i < 200; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds(10000));
+    }
+    ASSERT_TRUE(stableProxy->isAvailable());
+    ASSERT_TRUE(changingProxy->isAvailable());
+
+    std::atomic<bool> subscriptionSuccessful(false);
+    auto subscription = stableProxy->getTestSelectiveBroadcastSelectiveEvent().subscribe(
+            std::bind(&DBusBroadcastTest::selectiveBroadcastCallbackForProxyFromSameConnection1, this),
+            [&](const CommonAPI::CallStatus _status) {
+                EXPECT_EQ(CommonAPI::CallStatus::SUCCESS, _status);
+                subscriptionSuccessful = (CommonAPI::CallStatus::SUCCESS == _status);
+            });
+    for (unsigned int i = 0; !subscriptionSuccessful && i < 100; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds(10000));
+    }
+    ASSERT_TRUE(subscriptionSuccessful);
+
+    // The subscriber set of the stub adapter is replaced over and over while the
+    // broadcast is sent; the stable subscriber must see every single event.
+    const int numberOfBroadcasts = 500;
+    std::atomic<bool> isSending(true);
+    std::thread sender([&]() {
+        for (int i = 0; i < numberOfBroadcasts; i++) {
+            stub->send();
+        }
+        isSending = false;
+    });
+    while (isSending) {
+        auto changingSubscription = changingProxy->getTestSelectiveBroadcastSelectiveEvent().subscribe(
+                std::bind(&DBusBroadcastTest::selectiveBroadcastCallbackForProxyFromOtherConnection, this));
+        std::this_thread::sleep_for(std::chrono::microseconds(1000));
+        changingProxy->getTestSelectiveBroadcastSelectiveEvent().unsubscribe(changingSubscription);
+    }
+    sender.join();
+
+    for (unsigned int i = 0; selectiveBroadcastArrivedAtProxyFromSameConnection1 < numberOfBroadcasts && i < 500; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds(10000));
+    }
+    EXPECT_EQ(numberOfBroadcasts, selectiveBroadcastArrivedAtProxyFromSameConnection1);
+
+    stableProxy->getTestSelectiveBroadcastSelectiveEvent().unsubscribe(subscription);
 }
 
 TEST_F(DBusBroadcastTest, ProxysCanBeRejectedForSelectiveBroadcast) {
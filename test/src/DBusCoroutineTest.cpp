@@ -0,0 +1,144 @@
+// Copyright (C) 2015 Bayerische Motoren Werke Aktiengesellschaft (BMW AG)
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef _GLIBCXX_USE_NANOSLEEP
+#define _GLIBCXX_USE_NANOSLEEP
+#endif
+
+#include <CommonAPI/CommonAPI.hpp>
+
+#ifndef COMMONAPI_INTERNAL_COMPILATION
+#define COMMONAPI_INTERNAL_COMPILATION
+#endif
+
+#include <CommonAPI/DBus/DBusFactory.hpp>
+
+#include <v1/test/coroutine/TestInterfaceDBusProxy.hpp>
+#include <v1/test/coroutine/TestInterfaceStubDefault.hpp>
+
+#include <gtest/gtest.h>
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+
+static const std::string domain = "local";
+static const std::string instance = "CommonAPI.DBus.tests.DBusCoroutineTestService";
+static const std::string unavailableInstance = "CommonAPI.DBus.tests.DBusCoroutineTestService2";
+
+#define VERSION v1_0
+
+typedef VERSION::test::coroutine::TestInterface TestInterface;
+typedef VERSION::test::coroutine::TestInterfaceDBusProxy TestInterfaceDBusProxy;
+typedef std::tuple<CommonAPI::CallStatus, TestInterface::divideError, int32_t> DivideResult;
+
+class CoroutineStub : public VERSION::test::coroutine::TestInterfaceStubDefault {
+public:
+    virtual void divide(const std::shared_ptr<CommonAPI::ClientId> _client,
+                        int32_t _dividend, int32_t _divisor, divideReply_t _reply) {
+        (void)_client;
+        if (_divisor == 0) {
+            _reply(TestInterface::divideError::DIVISION_BY_ZERO, 0);
+        } else {
+            _reply(TestInterface::divideError::OK, _dividend / _divisor);
+        }
+    }
+};
+
+// Runs from its start until the first co_await and is then resumed by the reply.
+struct Task {
+    struct promise_type {
+        Task get_return_object() { return Task(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// The promise is shared with the coroutine, which may still run if the test fails.
+static Task divide(TestInterfaceDBusProxy &_proxy, int32_t _dividend, int32_t _divisor,
+                   const CommonAPI::CallInfo *_info, std::shared_ptr<std::promise<DivideResult>> _result) {
+    _result->set_value(co_await _proxy.divideCo(_dividend, _divisor, _info));
+}
+
+// The awaiters are members of the D-Bus proxy, which the D-Bus factory creates.
+static std::shared_ptr<TestInterfaceDBusProxy> createProxy(const std::string &_instance) {
+    return std::dynamic_pointer_cast<TestInterfaceDBusProxy>(
+        CommonAPI::DBus::Factory::get()->createProxy(domain, TestInterface::getInterface(), _instance, "clientConnection"));
+}
+
+// coroutine.fidl is generated with the awaitable proxy methods (-co).
+class CoroutineTest: public ::testing::Test {
+
+protected:
+    void SetUp() {
+        runtime_ = CommonAPI::Runtime::get();
+
+        stub_ = std::make_shared<CoroutineStub>();
+        ASSERT_TRUE(runtime_->registerService(domain, instance, stub_, "serviceConnection"));
+
+        proxy_ = createProxy(instance);
+        ASSERT_TRUE((bool)proxy_);
+        for (int i = 0; !proxy_->isAvailable() && i < 100; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ASSERT_TRUE(proxy_->isAvailable());
+    }
+
+    virtual void TearDown() {
+        proxy_.reset();
+        runtime_->unregisterService(domain, TestInterface::getInterface(), instance);
+        stub_.reset();
+        std::this_thread::sleep_for(std::chrono::microseconds(300000));
+    }
+
+    DivideResult await(TestInterfaceDBusProxy &_proxy, int32_t _dividend, int32_t _divisor,
+                       const CommonAPI::CallInfo *_info = nullptr) {
+        std::shared_ptr<std::promise<DivideResult>> itsResult(std::make_shared<std::promise<DivideResult>>());
+        std::future<DivideResult> itsFuture = itsResult->get_future();
+        divide(_proxy, _dividend, _divisor, _info, itsResult);
+        if (itsFuture.wait_for(std::chrono::seconds(10)) != std::future_status::ready) {
+            ADD_FAILURE() << "The awaited call did not resume the coroutine";
+            return DivideResult(CommonAPI::CallStatus::UNKNOWN, TestInterface::divideError::OK, 0);
+        }
+        return itsFuture.get();
+    }
+
+    std::shared_ptr<CommonAPI::Runtime> runtime_;
+    std::shared_ptr<CoroutineStub> stub_;
+    std::shared_ptr<TestInterfaceDBusProxy> proxy_;
+};
+
+TEST_F(CoroutineTest, AwaitedCallReturnsTheReply) {
+    const DivideResult result = await(*proxy_, 42, 6);
+    EXPECT_EQ(CommonAPI::CallStatus::SUCCESS, std::get<0>(result));
+    EXPECT_TRUE(std::get<1>(result) == TestInterface::divideError::OK);
+    EXPECT_EQ(7, std::get<2>(result));
+}
+
+TEST_F(CoroutineTest, AwaitedCallReturnsTheErrorOfTheStub) {
+    const DivideResult result = await(*proxy_, 42, 0);
+    EXPECT_EQ(CommonAPI::CallStatus::SUCCESS, std::get<0>(result));
+    EXPECT_TRUE(std::get<1>(result) == TestInterface::divideError::DIVISION_BY_ZERO);
+}
+
+TEST_F(CoroutineTest, AwaitedCallFailsWithoutService) {
+    std::shared_ptr<TestInterfaceDBusProxy> unavailableProxy = createProxy(unavailableInstance);
+    ASSERT_TRUE((bool)unavailableProxy);
+    const CommonAPI::CallInfo info(100);
+    const DivideResult result = await(*unavailableProxy, 42, 6, &info);
+    EXPECT_NE(CommonAPI::CallStatus::SUCCESS, std::get<0>(result));
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
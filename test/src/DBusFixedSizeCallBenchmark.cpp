@@ -0,0 +1,226 @@
+// Copyright (C) 2015 Bayerische Motoren Werke Aktiengesellschaft (BMW AG)
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "AllocationCounter.hpp"
+
+#include "CommonAPI/CommonAPI.hpp"
+
+#ifndef COMMONAPI_INTERNAL_COMPILATION
+#define COMMONAPI_INTERNAL_COMPILATION
+#endif
+
+#include "CommonAPI/DBus/DBusConnection.hpp"
+#include "CommonAPI/DBus/DBusProxyHelper.hpp"
+
+#define VERSION v1_0
+
+#include <v1/commonapi/tests/TestInterfaceDBusProxy.hpp>
+#include <v1/commonapi/tests/TestInterfaceDBusStubAdapter.hpp>
+#include <v1/commonapi/tests/TestInterfaceStubDefault.hpp>
+
+static const std::string interfaceName = "commonapi.tests.TestInterface.v1_0";
+static const std::string busName = "commonapi.tests.TestInterface_CommonAPI.DBus.tests.DBusFixedSizeCallTestService";
+static const std::string objectPath = "/CommonAPI/DBus/tests/DBusFixedSizeCallTestService";
+
+static const uint32_t numberOfCalls = 10000;
+
+class FixedSizeTestStub : public VERSION::commonapi::tests::TestInterfaceStubDefault {
+public:
+    void testFixedSizeMethod(const std::shared_ptr<CommonAPI::ClientId> _client,
+                             bool _boolInValue, int16_t _int16InValue, double _doubleInValue, uint8_t _uint8InValue,
+                             testFixedSizeMethodReply_t _reply) {
+        (void)_client;
+        _reply(!_boolInValue,
+               int64_t(_int16InValue) * _uint8InValue,
+               float(_doubleInValue / 2));
+    }
+
+    void testFixedSizeStructMethod(const std::shared_ptr<CommonAPI::ClientId> _client,
+                                   ::commonapi::tests::DerivedTypeCollection::TestFixedSizeStruct _structInValue,
+                                   uint32_t _uint32InValue,
+                                   testFixedSizeStructMethodReply_t _reply) {
+        (void)_client;
+        ::commonapi::tests::DerivedTypeCollection::TestFixedSizeStruct structOutValue(
+            uint8_t(_structInValue.getByteValue() + 1),
+            _structInValue.getDoubleValue() * 2,
+            !_structInValue.getBoolValue(),
+            int16_t(-_structInValue.getInt16Value()));
+        _reply(_uint32InValue + 1, structOutValue);
+    }
+};
+
+// The way every method was called before: argument tuples of Deployables, serialized
+// by DBusOutputStream and deserialized by DBusInputStream.
+typedef CommonAPI::DBus::DBusProxyHelper<
+        CommonAPI::DBus::DBusSerializableArguments<
+            CommonAPI::Deployable<bool, CommonAPI::EmptyDeployment>,
+            CommonAPI::Deployable<int16_t, CommonAPI::EmptyDeployment>,
+            CommonAPI::Deployable<double, CommonAPI::EmptyDeployment>,
+            CommonAPI::Deployable<uint8_t, CommonAPI::EmptyDeployment>
+        >,
+        CommonAPI::DBus::DBusSerializableArguments<
+            CommonAPI::Deployable<bool, CommonAPI::EmptyDeployment>,
+            CommonAPI::Deployable<int64_t, CommonAPI::EmptyDeployment>,
+            CommonAPI::Deployable<float, CommonAPI::EmptyDeployment>
+        >
+    > GenericProxyHelper;
+
+class FixedSizeCallTest: public ::testing::Test {
+protected:
+    void SetUp() {
+        proxyDBusConnection_ = CommonAPI::DBus::DBusConnection::getBus(CommonAPI::DBus::DBusType_t::SESSION, "clientConnection");
+        ASSERT_TRUE(proxyDBusConnection_->connect());
+
+        proxy_ = std::make_shared<VERSION::commonapi::tests::TestInterfaceDBusProxy>(CommonAPI::DBus::DBusAddress(busName, objectPath, interfaceName), proxyDBusConnection_);
+        proxy_->init();
+
+        stubDBusConnection_ = CommonAPI::DBus::DBusConnection::getBus(CommonAPI::DBus::DBusType_t::SESSION, "serviceConnection");
+        ASSERT_TRUE(stubDBusConnection_->connect());
+
+        stub_ = std::make_shared<FixedSizeTestStub>();
+        stubAdapter_ = std::make_shared<VERSION::commonapi::tests::TestInterfaceDBusStubAdapter<VERSION::commonapi::tests::TestInterfaceStub>>(CommonAPI::DBus::DBusAddress(busName, objectPath, interfaceName), stubDBusConnection_, stub_);
+        stubAdapter_->init(stubAdapter_);
+
+        const bool isStubAdapterRegistered = CommonAPI::Runtime::get()->registerService(
+            stubAdapter_->getAddress().getDomain(), stubAdapter_->getAddress().getInstance(), stub_);
+        ASSERT_TRUE(isStubAdapterRegistered);
+
+        for (unsigned int i = 0; !proxy_->isAvailable() && i < 100; ++i) {
+            std::this_thread::sleep_for(std::chrono::microseconds(10000));
+        }
+        ASSERT_TRUE(proxy_->isAvailable());
+    }
+
+    void TearDown() {
+        const bool isStubAdapterUnregistered = CommonAPI::Runtime::get()->unregisterService(
+            stubAdapter_->getAddress().getDomain(), stubAdapter_->getInterface(), stubAdapter_->getAddress().getInstance());
+        ASSERT_TRUE(isStubAdapterUnregistered);
+        stubAdapter_.reset();
+
+        if (stubDBusConnection_->isConnected()) {
+            stubDBusConnection_->disconnect();
+        }
+        stubDBusConnection_.reset();
+        std::this_thread::sleep_for(std::chrono::microseconds(30000));
+    }
+
+    void callGenerated(bool _boolIn, int16_t _int16In, double _doubleIn, uint8_t _uint8In,
+                       CommonAPI::CallStatus& _status, bool& _boolOut, int64_t& _int64Out, float& _floatOut) {
+        proxy_->testFixedSizeMethod(_boolIn, _int16In, _doubleIn, _uint8In, _status, _boolOut, _int64Out, _floatOut);
+    }
+
+    void callGeneric(bool _boolIn, int16_t _int16In, double _doubleIn, uint8_t _uint8In,
+                     CommonAPI::CallStatus& _status, bool& _boolOut, int64_t& _int64Out, float& _floatOut) {
+        CommonAPI::Deployable<bool, CommonAPI::EmptyDeployment> deploy_boolInValue(_boolIn, static_cast<CommonAPI::EmptyDeployment*>(nullptr));
+        CommonAPI::Deployable<int16_t, CommonAPI::EmptyDeployment> deploy_int16InValue(_int16In, static_cast<CommonAPI::EmptyDeployment*>(nullptr));
+        CommonAPI::Deployable<double, CommonAPI::EmptyDeployment> deploy_doubleInValue(_doubleIn, static_cast<CommonAPI::EmptyDeployment*>(nullptr));
+        CommonAPI::Deployable<uint8_t, CommonAPI::EmptyDeployment> deploy_uint8InValue(_uint8In, static_cast<CommonAPI::EmptyDeployment*>(nullptr));
+        CommonAPI::Deployable<bool, CommonAPI::EmptyDeployment> deploy_boolOutValue(static_cast<CommonAPI::EmptyDeployment*>(nullptr));
+        CommonAPI::Deployable<int64_t, CommonAPI::EmptyDeployment> deploy_int64OutValue(static_cast<CommonAPI::EmptyDeployment*>(nullptr));
+        CommonAPI::Deployable<float, CommonAPI::EmptyDeployment> deploy_floatOutValue(static_cast<CommonAPI::EmptyDeployment*>(nullptr));
+        GenericProxyHelper::callMethodWithReply(
+            *proxy_,
+            "testFixedSizeMethod",
+            "bndy",
+            &CommonAPI::DBus::defaultCallInfo,
+            deploy_boolInValue, deploy_int16InValue, deploy_doubleInValue, deploy_uint8InValue,
+            _status,
+            deploy_boolOutValue, deploy_int64OutValue, deploy_floatOutValue);
+        _boolOut = deploy_boolOutValue.getValue();
+        _int64Out = deploy_int64OutValue.getValue();
+        _floatOut = deploy_floatOutValue.getValue();
+    }
+
+    template<typename _Call>
+    void measure(const char* _path, _Call _call) {
+        CommonAPI::CallStatus status;
+        bool boolOut(false);
+        int64_t int64Out(0);
+        float floatOut(0);
+
+        allocationCount = 0;
+        isCountingAllocations = true;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < numberOfCalls; i++) {
+            _call(true, int16_t(i), 3.0, uint8_t(i), status, boolOut, int64Out, floatOut);
+            ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, status);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        isCountingAllocations = false;
+
+        // Allocations include the ones of the service, which runs in this process.
+        printf("[ BENCH    ] %-10s %6u calls: %10.1f ns/call %8.1f allocs/call\n",
+               _path, numberOfCalls, double(elapsed.count()) / numberOfCalls,
+               double(allocationCount) / numberOfCalls);
+        fflush(stdout);
+    }
+
+    std::shared_ptr<CommonAPI::DBus::DBusConnection> proxyDBusConnection_;
+    std::shared_ptr<VERSION::commonapi::tests::TestInterfaceDBusProxy> proxy_;
+
+    std::shared_ptr<CommonAPI::DBus::DBusConnection> stubDBusConnection_;
+    std::shared_ptr<VERSION::commonapi::tests::TestInterfaceDBusStubAdapter<VERSION::commonapi::tests::TestInterfaceStub>> stubAdapter_;
+    std::shared_ptr<FixedSizeTestStub> stub_;
+};
+
+TEST_F(FixedSizeCallTest, FixedSizeArgumentsAreTransferred) {
+    CommonAPI::CallStatus status;
+    bool boolOut(false);
+    int64_t int64Out(0);
+    float floatOut(0);
+
+    callGenerated(false, -1234, 5.5, 200, status, boolOut, int64Out, floatOut);
+    ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, status);
+    EXPECT_TRUE(boolOut);
+    EXPECT_EQ(-246800, int64Out);
+    EXPECT_FLOAT_EQ(2.75f, floatOut);
+
+    callGeneric(false, -1234, 5.5, 200, status, boolOut, int64Out, floatOut);
+    ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, status);
+    EXPECT_TRUE(boolOut);
+    EXPECT_EQ(-246800, int64Out);
+    EXPECT_FLOAT_EQ(2.75f, floatOut);
+}
+
+TEST_F(FixedSizeCallTest, FixedSizeStructsAreTransferredThroughTheirLayout) {
+    CommonAPI::CallStatus status;
+    uint32_t uint32Out(0);
+    ::commonapi::tests::DerivedTypeCollection::TestFixedSizeStruct structOut;
+
+    proxy_->testFixedSizeStructMethod(
+        ::commonapi::tests::DerivedTypeCollection::TestFixedSizeStruct(41, 1.25, false, 300), 4711,
+        status, uint32Out, structOut);
+    ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, status);
+    EXPECT_EQ(4712u, uint32Out);
+    EXPECT_EQ(42, structOut.getByteValue());
+    EXPECT_EQ(2.5, structOut.getDoubleValue());
+    EXPECT_TRUE(structOut.getBoolValue());
+    EXPECT_EQ(-300, structOut.getInt16Value());
+}
+
+TEST_F(FixedSizeCallTest, GeneratedPathComparedToGenericPath) {
+    measure("generic", [this](bool _boolIn, int16_t _int16In, double _doubleIn, uint8_t _uint8In,
+                              CommonAPI::CallStatus& _status, bool& _boolOut, int64_t& _int64Out, float& _floatOut) {
+        callGeneric(_boolIn, _int16In, _doubleIn, _uint8In, _status, _boolOut, _int64Out, _floatOut);
+    });
+    measure("generated", [this](bool _boolIn, int16_t _int16In, double _doubleIn, uint8_t _uint8In,
+                                CommonAPI::CallStatus& _status, bool& _boolOut, int64_t& _int64Out, float& _floatOut) {
+        callGenerated(_boolIn, _int16In, _doubleIn, _uint8In, _status, _boolOut, _int64Out, _floatOut);
+    });
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+#endif
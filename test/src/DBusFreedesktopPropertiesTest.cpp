@@ -3,6 +3,9 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
+#include <atomic>
+#include <future>
+
 #include <gtest/gtest.h>
 
 #include <CommonAPI/CommonAPI.hpp>
@@ -11,13 +14,17 @@
 #define COMMONAPI_INTERNAL_COMPILATION
 #endif
 
+#include <CommonAPI/DBus/DBusConnection.hpp>
+
 #include <commonapi/tests/DerivedTypeCollection.hpp>
 #include <commonapi/tests/EnumTypes.hpp>
 #include <v1/commonapi/tests/TestFreedesktopInterfaceProxy.hpp>
 #include <v1/commonapi/tests/TestFreedesktopInterfaceStub.hpp>
 #include <v1/commonapi/tests/TestFreedesktopInterfaceStubDefault.hpp>
+#include <v1/commonapi/tests/TestFreedesktopInterfaceDBusStubAdapter.hpp>
 #include <v1/commonapi/tests/TestFreedesktopDerivedInterfaceProxy.hpp>
 #include <v1/commonapi/tests/TestFreedesktopDerivedInterfaceStubDefault.hpp>
+#include <v1/commonapi/tests/TestFreedesktopDerivedInterfaceDBusStubAdapter.hpp>
 
 #define VERSION v1_0
 
@@ -25,6 +32,21 @@ static const std::string domain = "local";
 static const std::string commonApiAddress = "commonapi.tests.TestFreedesktopInterface";
 static const std::string commonApiDerivedAddress = "commonapi.tests.TestFreedesktopDerivedInterface";
 
+// Counts how often the value of the readonly attribute is read via D-Bus.
+class CountingFreedesktopStub: public VERSION::commonapi::tests::TestFreedesktopInterfaceStubDefault {
+public:
+    CountingFreedesktopStub()
+        : numberOfReadonlyReads_(0) {
+    }
+
+    virtual const uint32_t &getTestReadonlyAttributeAttribute(const std::shared_ptr<CommonAPI::ClientId> _client) {
+        numberOfReadonlyReads_++;
+        return VERSION::commonapi::tests::TestFreedesktopInterfaceStubDefault::getTestReadonlyAttributeAttribute(_client);
+    }
+
+    std::atomic<uint32_t> numberOfReadonlyReads_;
+};
+
 class FreedesktopPropertiesTest: public ::testing::Test {
 protected:
     void SetUp() {
@@ -46,7 +68,7 @@ protected:
     }
 
     void registerTestStub() {
-        testStub_ = std::make_shared<VERSION::commonapi::tests::TestFreedesktopInterfaceStubDefault>();
+        testStub_ = std::make_shared<CountingFreedesktopStub>();
         const bool isServiceRegistered = runtime->registerService(domain, commonApiAddress, testStub_, "connection");
 
         ASSERT_TRUE(isServiceRegistered);
@@ -60,7 +82,7 @@ protected:
 
     std::shared_ptr<CommonAPI::Runtime> runtime;
     std::shared_ptr<VERSION::commonapi::tests::TestFreedesktopInterfaceProxy<>> proxy_;
-    std::shared_ptr<VERSION::commonapi::tests::TestFreedesktopInterfaceStubDefault> testStub_;
+    std::shared_ptr<CountingFreedesktopStub> testStub_;
 };
 
 TEST_F(FreedesktopPropertiesTest, GetBasicTypeAttribute) {
@@ -175,6 +197,143 @@ TEST_F(FreedesktopPropertiesTest, CanSendAndReceiveNotificationForEnumProperty)
     ASSERT_TRUE(callbackArrived);
 }
 
+TEST_F(FreedesktopPropertiesTest, AttributeBatchDefersNotificationsUntilCommit) {
+    auto stubAdapter = std::dynamic_pointer_cast<VERSION::commonapi::tests::TestFreedesktopInterfaceDBusStubAdapter<>>(testStub_->getStubAdapter());
+    ASSERT_TRUE((bool)stubAdapter);
+
+    std::atomic<uint32_t> predefinedNotifications(0);
+    std::atomic<uint32_t> lastPredefinedValue(0);
+    std::atomic<uint32_t> enumNotifications(0);
+    bool initialPredefinedCall = true;
+    bool initialEnumCall = true;
+
+    std::function<void(const uint32_t)> predefinedListener([&](const uint32_t value) {
+        // the first call is for the initial value. Ignore it.
+        if (initialPredefinedCall) {
+            initialPredefinedCall = false;
+        } else {
+            lastPredefinedValue = value;
+            predefinedNotifications++;
+        }
+    });
+    std::function<void(const ::commonapi::tests::EnumTypes::e1)> enumListener([&](const ::commonapi::tests::EnumTypes::e1 value) {
+        if (initialEnumCall) {
+            initialEnumCall = false;
+        } else {
+            bool isSame = (value == ::commonapi::tests::EnumTypes::e1::LastValue);
+            ASSERT_EQ(true, isSame);
+            enumNotifications++;
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::microseconds(200000));
+
+    proxy_->getTestPredefinedTypeAttributeAttribute().getChangedEvent().subscribe(predefinedListener);
+    proxy_->getEnumAttributeAttribute().getChangedEvent().subscribe(enumListener);
+
+    std::this_thread::sleep_for(std::chrono::microseconds(200000));
+
+    stubAdapter->beginAttributeBatch();
+    testStub_->setTestPredefinedTypeAttributeAttribute(9);
+    stubAdapter->beginAttributeBatch();
+    testStub_->setTestPredefinedTypeAttributeAttribute(10);
+    testStub_->setEnumAttributeAttribute(::commonapi::tests::EnumTypes::e1::LastValue);
+    // Committing the inner batch keeps the outer one open.
+    stubAdapter->commitAttributeBatch();
+
+    std::this_thread::sleep_for(std::chrono::microseconds(200000));
+    ASSERT_EQ(0u, predefinedNotifications);
+    ASSERT_EQ(0u, enumNotifications);
+
+    stubAdapter->commitAttributeBatch();
+
+    uint8_t waitCounter = 0;
+    while((predefinedNotifications == 0 || enumNotifications == 0) && waitCounter < 10) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50000));
+        waitCounter++;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100000));
+
+    // Only the last value set within the batch is announced.
+    ASSERT_EQ(1u, predefinedNotifications);
+    ASSERT_EQ(10u, lastPredefinedValue);
+    ASSERT_EQ(1u, enumNotifications);
+}
+
+TEST_F(FreedesktopPropertiesTest, CachedAttributeIsReadLocallyAndFreshAfterChange) {
+    auto& testAttribute = proxy_->getTestReadonlyAttributeAttribute();
+
+    CommonAPI::CallStatus callStatus(CommonAPI::CallStatus::REMOTE_ERROR);
+    uint32_t value(1);
+
+    // The first read is remote and subscribes to PropertiesChanged.
+    testAttribute.getValue(callStatus, value);
+    ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, callStatus);
+    ASSERT_EQ(0u, value);
+
+    // Wait for the initial value of the subscription.
+    std::this_thread::sleep_for(std::chrono::microseconds(500000));
+
+    // Once subscribed, reads do not reach the stub anymore.
+    const uint32_t readsWhenCached = testStub_->numberOfReadonlyReads_;
+    for (int i = 0; i < 1000; i++) {
+        callStatus = CommonAPI::CallStatus::REMOTE_ERROR;
+        testAttribute.getValue(callStatus, value);
+        ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, callStatus);
+        ASSERT_EQ(0u, value);
+    }
+    ASSERT_EQ(readsWhenCached, testStub_->numberOfReadonlyReads_.load());
+
+    // A change on the stub side reaches the cache via PropertiesChanged.
+    testStub_->setTestReadonlyAttributeAttribute(42);
+
+    uint8_t waitCounter = 0;
+    value = 0;
+    while (value != 42u && waitCounter < 20) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50000));
+        testAttribute.getValue(callStatus, value);
+        ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, callStatus);
+        waitCounter++;
+    }
+    ASSERT_EQ(42u, value);
+    ASSERT_EQ(readsWhenCached, testStub_->numberOfReadonlyReads_.load());
+
+    // Asynchronous reads are served from the cache as well.
+    std::promise<uint32_t> asyncValue;
+    testAttribute.getValueAsync([&](const CommonAPI::CallStatus &_status, uint32_t _value) {
+        EXPECT_EQ(CommonAPI::CallStatus::SUCCESS, _status);
+        asyncValue.set_value(_value);
+    });
+    ASSERT_EQ(42u, asyncValue.get_future().get());
+    ASSERT_EQ(readsWhenCached, testStub_->numberOfReadonlyReads_.load());
+}
+
+TEST_F(FreedesktopPropertiesTest, AvailabilityPrefetchesCachedAttributes) {
+    testStub_->setTestReadonlyAttributeAttribute(17);
+
+    auto prefetchingProxy = runtime->buildProxy<VERSION::commonapi::tests::TestFreedesktopInterfaceProxy>(domain, commonApiAddress, "prefetchClient");
+    ASSERT_TRUE((bool)prefetchingProxy);
+
+    // Reads all properties with GetAll and subscribes the cached attributes.
+    ASSERT_TRUE(prefetchingProxy->isAvailableBlocking());
+    const uint32_t readsAfterPrefetch = testStub_->numberOfReadonlyReads_;
+    ASSERT_LE(1u, readsAfterPrefetch);
+
+    auto& testAttribute = prefetchingProxy->getTestReadonlyAttributeAttribute();
+    CommonAPI::CallStatus callStatus(CommonAPI::CallStatus::REMOTE_ERROR);
+    uint32_t value(0);
+    for (int i = 0; i < 1000; i++) {
+        callStatus = CommonAPI::CallStatus::REMOTE_ERROR;
+        testAttribute.getValue(callStatus, value);
+        ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, callStatus);
+        ASSERT_EQ(17u, value);
+    }
+
+    // Only the initial value of the subscription may still be read by the runtime.
+    std::this_thread::sleep_for(std::chrono::microseconds(100000));
+    ASSERT_GE(readsAfterPrefetch + 1, testStub_->numberOfReadonlyReads_.load());
+}
+
 class FreedesktopPropertiesOnInheritedInterfacesTest: public ::testing::Test {
 protected:
     void SetUp() {
@@ -259,6 +418,110 @@ TEST_F(FreedesktopPropertiesOnInheritedInterfacesTest, CanGetAndSetRemoteAttribu
     ASSERT_EQ(value, 7u);
 }
 
+TEST_F(FreedesktopPropertiesOnInheritedInterfacesTest, AttributeBatchCoversAttributesOfAllInterfaces) {
+    auto stubAdapter = std::dynamic_pointer_cast<VERSION::commonapi::tests::TestFreedesktopDerivedInterfaceDBusStubAdapter<>>(
+            testStub_->CommonAPI::Stub<VERSION::commonapi::tests::TestFreedesktopDerivedInterfaceStubAdapter, VERSION::commonapi::tests::TestFreedesktopDerivedInterfaceStubRemoteEvent>::getStubAdapter());
+    ASSERT_TRUE((bool)stubAdapter);
+
+    // The batch is committed through the adapter of the base interface.
+    VERSION::commonapi::tests::TestFreedesktopInterfaceDBusStubAdapterInternal<
+        VERSION::commonapi::tests::TestFreedesktopDerivedInterfaceStub,
+        VERSION::commonapi::tests::TestFreedesktopInterfaceStub> &baseAdapter = *stubAdapter;
+
+    std::atomic<uint32_t> baseNotifications(0);
+    std::atomic<uint32_t> derivedNotifications(0);
+    bool initialBaseCall = true;
+    bool initialDerivedCall = true;
+
+    std::function<void(const uint32_t)> baseListener([&](const uint32_t value) {
+        // the first call is for the initial value. Ignore it.
+        if (initialBaseCall) {
+            initialBaseCall = false;
+        } else {
+            ASSERT_EQ(9u, value);
+            baseNotifications++;
+        }
+    });
+    std::function<void(const uint32_t)> derivedListener([&](const uint32_t value) {
+        if (initialDerivedCall) {
+            initialDerivedCall = false;
+        } else {
+            ASSERT_EQ(10u, value);
+            derivedNotifications++;
+        }
+    });
+
+    proxy_->getTestPredefinedTypeAttributeAttribute().getChangedEvent().subscribe(baseListener);
+    proxy_->getTestAttributedFromDerivedInterfaceAttribute().getChangedEvent().subscribe(derivedListener);
+
+    std::this_thread::sleep_for(std::chrono::microseconds(200000));
+
+    baseAdapter.beginAttributeBatch();
+    testStub_->setTestPredefinedTypeAttributeAttribute(9);
+    testStub_->setTestAttributedFromDerivedInterfaceAttribute(10);
+
+    std::this_thread::sleep_for(std::chrono::microseconds(200000));
+    ASSERT_EQ(0u, baseNotifications);
+    ASSERT_EQ(0u, derivedNotifications);
+
+    baseAdapter.commitAttributeBatch();
+
+    uint8_t waitCounter = 0;
+    while((baseNotifications == 0 || derivedNotifications == 0) && waitCounter < 10) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50000));
+        waitCounter++;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100000));
+
+    ASSERT_EQ(1u, baseNotifications);
+    ASSERT_EQ(1u, derivedNotifications);
+}
+
+// Gives access to the introspection data of a stub adapter that is never registered.
+template<class _Adapter, class _Stub>
+class IntrospectedStubAdapter: public _Adapter {
+public:
+    IntrospectedStubAdapter(const CommonAPI::DBus::DBusAddress &_address,
+                            const std::shared_ptr<CommonAPI::DBus::DBusProxyConnection> &_connection,
+                            const std::shared_ptr<_Stub> &_stub)
+        : CommonAPI::DBus::DBusStubAdapter(_address, _connection, false),
+          _Adapter(_address, _connection, _stub) {
+    }
+
+    std::string getIntrospectionData() const {
+        return this->getMethodsDBusIntrospectionXmlData();
+    }
+};
+
+TEST(FreedesktopPropertiesIntrospectionTest, DerivedInterfaceDataIsBaseDataFollowedByOwnMembers) {
+    auto connection = CommonAPI::DBus::DBusConnection::getBus(CommonAPI::DBus::DBusType_t::SESSION, "introspection");
+
+    IntrospectedStubAdapter<
+        VERSION::commonapi::tests::TestFreedesktopInterfaceDBusStubAdapterInternal<>,
+        VERSION::commonapi::tests::TestFreedesktopInterfaceStub> baseAdapter(
+            CommonAPI::DBus::DBusAddress("commonapi.tests.TestFreedesktopInterface_introspection",
+                                         "/introspection/base",
+                                         "commonapi.tests.TestFreedesktopInterface"),
+            connection,
+            std::make_shared<VERSION::commonapi::tests::TestFreedesktopInterfaceStubDefault>());
+    IntrospectedStubAdapter<
+        VERSION::commonapi::tests::TestFreedesktopDerivedInterfaceDBusStubAdapterInternal<>,
+        VERSION::commonapi::tests::TestFreedesktopDerivedInterfaceStub> derivedAdapter(
+            CommonAPI::DBus::DBusAddress("commonapi.tests.TestFreedesktopDerivedInterface_introspection",
+                                         "/introspection/derived",
+                                         "commonapi.tests.TestFreedesktopDerivedInterface"),
+            connection,
+            std::make_shared<VERSION::commonapi::tests::TestFreedesktopDerivedInterfaceStubDefault>());
+
+    // Derived adapters used to append their own members to the string of their base
+    // adapter at runtime. The flattened literal must not differ from that by a byte.
+    const std::string expectedData = baseAdapter.getIntrospectionData() +
+        "<property name=\"TestAttributedFromDerivedInterface\" type=\"u\" access=\"readwrite\" />\n";
+
+    ASSERT_FALSE(baseAdapter.getIntrospectionData().empty());
+    ASSERT_EQ(expectedData, derivedAdapter.getIntrospectionData());
+}
+
 #ifndef __NO_MAIN__
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
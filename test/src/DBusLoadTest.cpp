@@ -5,18 +5,22 @@
 
 #include <gtest/gtest.h>
 
-#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
-#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <functional>
+#include <iostream>
+#include <limits>
 #include <memory>
-#include <stdint.h>
+#include <mutex>
+#include <sstream>
 #include <string>
-#include <array>
-#include <utility>
-#include <tuple>
-#include <type_traits>
-#include <future>
+#include <thread>
+#include <vector>
 
 #include <CommonAPI/CommonAPI.hpp>
 
@@ -39,9 +43,9 @@
 class TestInterfaceStubFinal : public VERSION::commonapi::tests::TestInterfaceStubDefault {
 
 public:
-    void testPredefinedTypeMethod(const std::shared_ptr<CommonAPI::ClientId> _client, 
-                                    uint32_t _uint32InValue, 
-                                    std::string _stringInValue, 
+    void testPredefinedTypeMethod(const std::shared_ptr<CommonAPI::ClientId> _client,
+                                    uint32_t _uint32InValue,
+                                    std::string _stringInValue,
                                     testPredefinedTypeMethodReply_t _reply) {
         (void)_client;
         uint32_t uint32OutValue = _uint32InValue;
@@ -50,244 +54,429 @@ public:
     }
 };
 
-class DBusLoadTest: public ::testing::Test {
-protected:
-    virtual void SetUp() {
-        runtime_ = CommonAPI::Runtime::get();
-        ASSERT_TRUE((bool )runtime_);
-
-        callSucceeded_.resize(numCallsPerProxy_ * numProxies_);
-        std::fill(callSucceeded_.begin(), callSucceeded_.end(), false);
+/*
+ * Parameters of a load run. Every test defines its own defaults; each value can be
+ * overridden by the environment variable named next to it:
+ *
+ *   proxies        COMMONAPI_DBUS_LOAD_PROXIES       number of TestInterface proxies
+ *   connections    COMMONAPI_DBUS_LOAD_CONNECTIONS   client connections the proxies are spread over (0: one per proxy)
+ *   services       COMMONAPI_DBUS_LOAD_SERVICES      stub instances the proxies are spread over (0: one per proxy)
+ *   window         COMMONAPI_DBUS_LOAD_WINDOW        maximum number of async calls in flight per proxy
+ *   payloadSize    COMMONAPI_DBUS_LOAD_PAYLOAD       size of the echoed string argument in bytes
+ *   syncPercent    COMMONAPI_DBUS_LOAD_SYNC_PERCENT  share of calls issued synchronously (0..100)
+ *   durationMs     COMMONAPI_DBUS_LOAD_DURATION_MS   run time; 0 issues callsPerProxy calls instead
+ *   callsPerProxy  COMMONAPI_DBUS_LOAD_CALLS         calls per proxy if durationMs is 0
+ *
+ * The result of each run is written as one JSON line to stdout and, if
+ * COMMONAPI_DBUS_LOAD_REPORT names a file, appended to that file.
+ */
+struct LoadConfiguration {
+    uint32_t proxies;
+    uint32_t connections;
+    uint32_t services;
+    uint32_t window;
+    uint32_t payloadSize;
+    uint32_t syncPercent;
+    uint32_t durationMs;
+    uint32_t callsPerProxy;
+
+    void applyEnvironment() {
+        proxies = getValue("COMMONAPI_DBUS_LOAD_PROXIES", proxies);
+        connections = getValue("COMMONAPI_DBUS_LOAD_CONNECTIONS", connections);
+        services = getValue("COMMONAPI_DBUS_LOAD_SERVICES", services);
+        window = getValue("COMMONAPI_DBUS_LOAD_WINDOW", window);
+        payloadSize = getValue("COMMONAPI_DBUS_LOAD_PAYLOAD", payloadSize);
+        syncPercent = getValue("COMMONAPI_DBUS_LOAD_SYNC_PERCENT", syncPercent);
+        durationMs = getValue("COMMONAPI_DBUS_LOAD_DURATION_MS", durationMs);
+        callsPerProxy = getValue("COMMONAPI_DBUS_LOAD_CALLS", callsPerProxy);
+
+        if (proxies == 0) proxies = 1;
+        if (connections == 0 || connections > proxies) connections = proxies;
+        if (services == 0 || services > proxies) services = proxies;
+        if (window == 0) window = 1;
+        if (syncPercent > 100) syncPercent = 100;
     }
 
-    virtual void TearDown() {
-        std::this_thread::sleep_for(std::chrono::microseconds(1000000));
+private:
+    static uint32_t getValue(const char* _name, uint32_t _default) {
+        const char* value = std::getenv(_name);
+        return (value ? uint32_t(std::strtoul(value, NULL, 10)) : _default);
     }
+};
 
+/*
+ * Log-linear latency histogram (32 buckets per power of two, i.e. ~3% resolution)
+ * over nanoseconds.
+ */
+class LatencyHistogram {
 public:
-    void TestPredefinedTypeMethodAsyncCallback(
-                                               const uint32_t callId,
-                                               const uint32_t in1,
-                                               const std::string in2,
-                                               const CommonAPI::CallStatus& callStatus,
-                                               const uint32_t& out1,
-                                               const std::string& out2) {
-        EXPECT_EQ(callStatus, CommonAPI::CallStatus::SUCCESS);
-        EXPECT_EQ(out1, in1);
-        EXPECT_EQ(out2, in2);
-        mutexCallSucceeded_.lock();
-        ASSERT_FALSE(callSucceeded_[callId]);
-        callSucceeded_[callId] = true;
-        mutexCallSucceeded_.unlock();
+    LatencyHistogram()
+        : buckets_(numBuckets_, 0),
+          count_(0),
+          sum_(0),
+          min_(std::numeric_limits<uint64_t>::max()),
+          max_(0) {
     }
 
-    std::shared_ptr<CommonAPI::Runtime> runtime_;
-    std::vector<bool> callSucceeded_;
-    std::mutex mutexCallSucceeded_;
+    void record(std::chrono::nanoseconds _latency) {
+        uint64_t value = uint64_t(_latency.count() < 0 ? 0 : _latency.count());
+        buckets_[getBucket(value)]++;
+        count_++;
+        sum_ += value;
+        if (value < min_) min_ = value;
+        if (value > max_) max_ = value;
+    }
 
-    static const std::string domain_;
-    static const std::string serviceAddress_;
-    static const uint32_t numCallsPerProxy_;
-    static const uint32_t numProxies_;
-};
+    void merge(const LatencyHistogram& _other) {
+        for (size_t i = 0; i < numBuckets_; i++) {
+            buckets_[i] += _other.buckets_[i];
+        }
+        count_ += _other.count_;
+        sum_ += _other.sum_;
+        if (_other.min_ < min_) min_ = _other.min_;
+        if (_other.max_ > max_) max_ = _other.max_;
+    }
 
-const std::string DBusLoadTest::domain_ = "local";
-const std::string DBusLoadTest::serviceAddress_ = "CommonAPI.DBus.tests.DBusProxyTestService";
-const uint32_t DBusLoadTest::numCallsPerProxy_ = 100;
+    uint64_t getCount() const {
+        return count_;
+    }
 
-#ifdef _WIN32
-// test with just 50 proxies under windows as it becomes very slow with more ones
-const uint32_t DBusLoadTest::numProxies_ = 50;
-#else
-const uint32_t DBusLoadTest::numProxies_ = 65;
-#endif
+    double getMinUs() const {
+        return (count_ ? double(min_) / 1000.0 : 0.0);
+    }
 
-// Multiple proxies in one thread, one stub
-TEST_F(DBusLoadTest, SingleClientMultipleProxiesSingleStubCallsSucceed) {
-    std::array<std::shared_ptr<VERSION::commonapi::tests::TestInterfaceProxyBase>, numProxies_> testProxies;
+    double getMaxUs() const {
+        return double(max_) / 1000.0;
+    }
 
-    for (unsigned int i = 0; i < numProxies_; i++) {
-        testProxies[i] = runtime_->buildProxy < VERSION::commonapi::tests::TestInterfaceProxy >(domain_, serviceAddress_);
-        ASSERT_TRUE((bool )testProxies[i]);
+    double getMeanUs() const {
+        return (count_ ? double(sum_) / double(count_) / 1000.0 : 0.0);
     }
 
-    auto stub = std::make_shared<TestInterfaceStubFinal>();
-    bool serviceRegistered = runtime_->registerService(domain_, serviceAddress_, stub, "connection");
-    for (auto i = 0; !serviceRegistered && i < 100; ++i) {
-        serviceRegistered = runtime_->registerService(domain_, serviceAddress_, stub, "connection");
-        std::this_thread::sleep_for(std::chrono::microseconds(10000));
+    double getPercentileUs(double _percentile) const {
+        if (count_ == 0) {
+            return 0.0;
+        }
+        uint64_t rank = uint64_t(_percentile * double(count_) + 0.5);
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < numBuckets_; i++) {
+            seen += buckets_[i];
+            if (seen >= rank) {
+                uint64_t value = getBucketValue(i);
+                return double(value > max_ ? max_ : value) / 1000.0;
+            }
+        }
+        return getMaxUs();
     }
-    ASSERT_TRUE(serviceRegistered);
 
-    bool allProxiesAvailable = false;
-    for (unsigned int i = 0; !allProxiesAvailable && i < 100; ++i) {
-        allProxiesAvailable = true;
-        for (unsigned int j = 0; j < numProxies_; ++j) {
-            allProxiesAvailable = allProxiesAvailable && testProxies[j]->isAvailable();
+private:
+    static const uint32_t subBucketBits_ = 5;
+    static const uint64_t subBuckets_ = (1 << subBucketBits_);
+    static const size_t numBuckets_ = 64 * subBuckets_;
+
+    static size_t getBucket(uint64_t _value) {
+        if (_value < 2 * subBuckets_) {
+            return size_t(_value);
         }
-        if (!allProxiesAvailable)
-            std::this_thread::sleep_for(std::chrono::microseconds(10000));
+        uint32_t msb = 0;
+        for (uint64_t v = _value; v > 1; v >>= 1) msb++;
+        uint32_t shift = msb - subBucketBits_;
+        return size_t(shift * subBuckets_ + (_value >> shift));
     }
-    ASSERT_TRUE(allProxiesAvailable);
-
-    uint32_t callId = 0;
-    for (unsigned int i = 0; i < numCallsPerProxy_; i++) {
-        for (unsigned int j = 0; j < numProxies_; j++) {
-            uint32_t in1 = i;
-            std::string in2 = "string" + std::to_string(i) + "_" + std::to_string(j);
-            testProxies[j]->testPredefinedTypeMethodAsync(
-                            in1,
-                            in2,
-                            std::bind(
-                                      &DBusLoadTest::TestPredefinedTypeMethodAsyncCallback,
-                                      this,
-                                      callId++,
-                                      in1,
-                                      in2,
-                                      std::placeholders::_1,
-                                      std::placeholders::_2,
-                                      std::placeholders::_3));
+
+    // Upper bound of the bucket, so percentiles are never reported too optimistic.
+    static uint64_t getBucketValue(size_t _bucket) {
+        if (_bucket < 2 * subBuckets_) {
+            return _bucket;
         }
+        uint64_t shift = _bucket / subBuckets_ - 1;
+        uint64_t mantissa = _bucket - shift * subBuckets_;
+        return ((mantissa + 1) << shift) - 1;
     }
 
-    bool allCallsSucceeded = false;
-    for (unsigned int i = 0; !allCallsSucceeded && i < 100; ++i) {
-        allCallsSucceeded = std::all_of(callSucceeded_.cbegin(), callSucceeded_.cend(), [](int b){ return b; });
-        if (!allCallsSucceeded)
-            std::this_thread::sleep_for(std::chrono::microseconds(100000));
+    std::vector<uint64_t> buckets_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t min_;
+    uint64_t max_;
+};
+
+/*
+ * Drives the calls of one proxy and collects their results. Async replies are
+ * accounted on the dispatch thread of the proxy's connection.
+ */
+struct LoadDriver {
+    std::shared_ptr<VERSION::commonapi::tests::TestInterfaceProxyBase> proxy_;
+    std::mutex mutex_;
+    std::condition_variable inFlightCondition_;
+    uint32_t inFlight_ = 0;
+    uint64_t sent_ = 0;
+    uint64_t succeeded_ = 0;
+    uint64_t failed_ = 0;
+    LatencyHistogram histogram_;
+
+    void complete(std::chrono::steady_clock::time_point _start, bool _isSuccess, bool _isAsync) {
+        auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start);
+        std::lock_guard<std::mutex> itsLock(mutex_);
+        if (_isSuccess) {
+            succeeded_++;
+            histogram_.record(latency);
+        } else {
+            failed_++;
+        }
+        if (_isAsync) {
+            inFlight_--;
+            inFlightCondition_.notify_all();
+        }
     }
-    ASSERT_TRUE(allCallsSucceeded);
 
-    runtime_->unregisterService(domain_, stub->getStubAdapter()->getInterface(), serviceAddress_);
-}
+    void run(const LoadConfiguration& _configuration, std::chrono::steady_clock::time_point _deadline) {
+        const std::string payload(_configuration.payloadSize, 'x');
+        const size_t payloadSize = payload.size();
+
+        for (uint32_t callNumber = 0;
+             (_configuration.durationMs > 0 ?
+                 std::chrono::steady_clock::now() < _deadline :
+                 callNumber < _configuration.callsPerProxy);
+             callNumber++) {
+            const uint32_t in1 = callNumber;
+            const bool isSync = (callNumber % 100 < _configuration.syncPercent);
+
+            if (isSync) {
+                {
+                    std::lock_guard<std::mutex> itsLock(mutex_);
+                    sent_++;
+                }
+                CommonAPI::CallStatus callStatus;
+                uint32_t out1;
+                std::string out2;
+                auto start = std::chrono::steady_clock::now();
+                proxy_->testPredefinedTypeMethod(in1, payload, callStatus, out1, out2);
+                complete(start,
+                         callStatus == CommonAPI::CallStatus::SUCCESS && out1 == in1 && out2.size() == payloadSize,
+                         false);
+            } else {
+                {
+                    std::unique_lock<std::mutex> itsLock(mutex_);
+                    inFlightCondition_.wait(itsLock, [&]() { return inFlight_ < _configuration.window; });
+                    inFlight_++;
+                    sent_++;
+                }
+                auto start = std::chrono::steady_clock::now();
+                proxy_->testPredefinedTypeMethodAsync(
+                        in1,
+                        payload,
+                        [this, start, in1, payloadSize](const CommonAPI::CallStatus& _status,
+                                                        const uint32_t& _out1,
+                                                        const std::string& _out2) {
+                            complete(start,
+                                     _status == CommonAPI::CallStatus::SUCCESS && _out1 == in1 && _out2.size() == payloadSize,
+                                     true);
+                        });
+            }
+        }
 
-// Multiple proxies in separate threads, one stub
-TEST_F(DBusLoadTest, MultipleClientsSingleStubCallsSucceed) {
-    std::array<std::shared_ptr<CommonAPI::Factory>, numProxies_> testProxyFactories;
-    std::array<std::shared_ptr<VERSION::commonapi::tests::TestInterfaceProxyBase>, numProxies_> testProxies;
+        // The pending callbacks refer to this driver, so it must not go away before all
+        // of them ran. Every async call completes, at the latest with its call timeout.
+        std::unique_lock<std::mutex> itsLock(mutex_);
+        const bool isDrained = inFlightCondition_.wait_for(itsLock, std::chrono::seconds(30), [&]() { return inFlight_ == 0; });
+        EXPECT_TRUE(isDrained) << inFlight_ << " async calls are still pending after 30 seconds";
+        inFlightCondition_.wait(itsLock, [&]() { return inFlight_ == 0; });
+    }
+};
+
+class DBusLoadTest: public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        runtime_ = CommonAPI::Runtime::get();
+        ASSERT_TRUE((bool )runtime_);
 
-    for (unsigned int i = 0; i < numProxies_; i++) {
-        testProxies[i] = runtime_->buildProxy < VERSION::commonapi::tests::TestInterfaceProxy >(domain_, serviceAddress_);
-        ASSERT_TRUE((bool )testProxies[i]);
+        configuration_.proxies = defaultNumProxies_;
+        configuration_.connections = 1;
+        configuration_.services = 1;
+        configuration_.window = defaultNumCallsPerProxy_;
+        configuration_.payloadSize = 16;
+        configuration_.syncPercent = 0;
+        configuration_.durationMs = 0;
+        configuration_.callsPerProxy = defaultNumCallsPerProxy_;
     }
 
-    auto stub = std::make_shared<TestInterfaceStubFinal>();
-    bool serviceRegistered = false;
-    for (auto i = 0; !serviceRegistered && i < 100; ++i) {
-        serviceRegistered = runtime_->registerService(domain_, serviceAddress_, stub, "connection");
-        if(!serviceRegistered)
-            std::this_thread::sleep_for(std::chrono::microseconds(10000));
+    virtual void TearDown() {
     }
-    ASSERT_TRUE(serviceRegistered);
 
-    bool allProxiesAvailable = false;
-    for (unsigned int i = 0; !allProxiesAvailable && i < 100; ++i) {
-        allProxiesAvailable = true;
-        for (unsigned int j = 0; j < numProxies_; ++j) {
-            allProxiesAvailable = allProxiesAvailable && testProxies[j]->isAvailable();
+    void runLoad() {
+        configuration_.applyEnvironment();
+
+        std::vector<std::shared_ptr<TestInterfaceStubFinal>> stubs;
+        std::vector<std::unique_ptr<LoadDriver>> drivers;
+
+        for (uint32_t i = 0; i < configuration_.proxies; i++) {
+            std::unique_ptr<LoadDriver> driver(new LoadDriver);
+            driver->proxy_ = runtime_->buildProxy<VERSION::commonapi::tests::TestInterfaceProxy>(
+                    domain_,
+                    getServiceAddress(i % configuration_.services),
+                    "client" + std::to_string(i % configuration_.connections));
+            ASSERT_TRUE((bool )driver->proxy_);
+            drivers.push_back(std::move(driver));
         }
-        if (!allProxiesAvailable)
-            std::this_thread::sleep_for(std::chrono::microseconds(10000));
-    }
-    ASSERT_TRUE(allProxiesAvailable);
-
-    uint32_t callId = 0;
-    for (unsigned int i = 0; i < numCallsPerProxy_; i++) {
-        for (unsigned int j = 0; j < numProxies_; j++) {
-            uint32_t in1 = i;
-            std::string in2 = "string" + std::to_string(i) + "_" + std::to_string(j);
-            testProxies[j]->testPredefinedTypeMethodAsync(
-                            in1,
-                            in2,
-                            std::bind(
-                                      &DBusLoadTest::TestPredefinedTypeMethodAsyncCallback,
-                                      this,
-                                      callId++,
-                                      in1,
-                                      in2,
-                                      std::placeholders::_1,
-                                      std::placeholders::_2,
-                                      std::placeholders::_3));
+
+        for (uint32_t i = 0; i < configuration_.services; i++) {
+            auto stub = std::make_shared<TestInterfaceStubFinal>();
+            bool serviceRegistered = false;
+            for (auto j = 0; !serviceRegistered && j < 100; ++j) {
+                serviceRegistered = runtime_->registerService(domain_, getServiceAddress(i), stub, "service" + std::to_string(i));
+                if (!serviceRegistered)
+                    std::this_thread::sleep_for(std::chrono::microseconds(10000));
+            }
+            ASSERT_TRUE(serviceRegistered);
+            stubs.push_back(stub);
         }
-    }
 
-    bool allCallsSucceeded = false;
-    for (unsigned int i = 0; !allCallsSucceeded && i < 100; ++i) {
-        allCallsSucceeded = std::all_of(callSucceeded_.cbegin(), callSucceeded_.cend(), [](int b){ return b; });
-        if (!allCallsSucceeded)
-            std::this_thread::sleep_for(std::chrono::microseconds(100000));
-    }
-    ASSERT_TRUE(allCallsSucceeded);
+        bool allProxiesAvailable = false;
+        for (unsigned int i = 0; !allProxiesAvailable && i < 1000; ++i) {
+            allProxiesAvailable = true;
+            for (auto &driver : drivers) {
+                allProxiesAvailable = allProxiesAvailable && driver->proxy_->isAvailable();
+            }
+            if (!allProxiesAvailable)
+                std::this_thread::sleep_for(std::chrono::microseconds(10000));
+        }
+        ASSERT_TRUE(allProxiesAvailable);
 
-    runtime_->unregisterService(domain_, stub->getStubAdapter()->getInterface(), serviceAddress_);
-}
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = start + std::chrono::milliseconds(configuration_.durationMs);
+        std::vector<std::thread> threads;
+        for (auto &driver : drivers) {
+            threads.push_back(std::thread(&LoadDriver::run, driver.get(), std::cref(configuration_), deadline));
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+        LatencyHistogram histogram;
+        uint64_t sent(0), succeeded(0), failed(0);
+        for (auto &driver : drivers) {
+            std::lock_guard<std::mutex> itsLock(driver->mutex_);
+            histogram.merge(driver->histogram_);
+            sent += driver->sent_;
+            succeeded += driver->succeeded_;
+            failed += driver->failed_;
+        }
 
-// Multiple proxies in separate threads, multiple stubs in separate threads
-TEST_F(DBusLoadTest, MultipleClientsMultipleServersCallsSucceed) {
-    std::array<std::shared_ptr<CommonAPI::Factory>, numProxies_> testProxyFactories;
-    std::array<std::shared_ptr<CommonAPI::Factory>, numProxies_> testStubFactories;
-    std::array<std::shared_ptr<VERSION::commonapi::tests::TestInterfaceProxyBase>, numProxies_> testProxies;
-    std::array<std::shared_ptr<VERSION::commonapi::tests::TestInterfaceStub>, numProxies_> testStubs;
-
-    for (unsigned int i = 0; i < numProxies_; i++) {
-        testProxies[i] = runtime_->buildProxy < VERSION::commonapi::tests::TestInterfaceProxy >(domain_, serviceAddress_ + std::to_string(i));
-        ASSERT_TRUE((bool )testProxies[i]);
-    }
+        report(elapsed, sent, succeeded, failed, histogram);
 
-    for (unsigned int i = 0; i < numProxies_; i++) {
-        testStubs[i] = std::make_shared<TestInterfaceStubFinal>();
-        ASSERT_TRUE((bool )testStubs[i]);
-        bool serviceRegistered = false;
-        for (auto j = 0; !serviceRegistered && j < 100; ++j) {
-            serviceRegistered = runtime_->registerService(domain_, serviceAddress_ + std::to_string(i), testStubs[i], "connection");
-            if(!serviceRegistered)
-                std::this_thread::sleep_for(std::chrono::microseconds(10000));
+        for (uint32_t i = 0; i < configuration_.services; i++) {
+            runtime_->unregisterService(domain_, stubs[i]->getStubAdapter()->getInterface(), getServiceAddress(i));
         }
-        ASSERT_TRUE(serviceRegistered);
-    }
 
-    bool allProxiesAvailable = false;
-    for (unsigned int i = 0; !allProxiesAvailable && i < 100; ++i) {
-        allProxiesAvailable = true;
-        for (unsigned int j = 0; j < numProxies_; ++j) {
-            allProxiesAvailable = allProxiesAvailable && testProxies[j]->isAvailable();
+        // Wait for the deregistration to be seen instead of sleeping a fixed time, so the
+        // next test can register the same addresses.
+        bool anyProxyAvailable = true;
+        for (unsigned int i = 0; anyProxyAvailable && i < 200; ++i) {
+            anyProxyAvailable = false;
+            for (auto &driver : drivers) {
+                anyProxyAvailable = anyProxyAvailable || driver->proxy_->isAvailable();
+            }
+            if (anyProxyAvailable)
+                std::this_thread::sleep_for(std::chrono::microseconds(10000));
         }
-        if (!allProxiesAvailable)
-            std::this_thread::sleep_for(std::chrono::microseconds(1000000));
+
+        ASSERT_EQ(0u, failed);
+        ASSERT_EQ(sent, succeeded);
+        ASSERT_GT(succeeded, 0u);
     }
-    ASSERT_TRUE(allProxiesAvailable);
-
-    uint32_t callId = 0;
-    for (unsigned int i = 0; i < numCallsPerProxy_; i++) {
-        for (unsigned int j = 0; j < numProxies_; j++) {
-            uint32_t in1 = i;
-            std::string in2 = "string" + std::to_string(i) + "_" + std::to_string(j);
-            testProxies[j]->testPredefinedTypeMethodAsync(
-                            in1,
-                            in2,
-                            std::bind(
-                                      &DBusLoadTest::TestPredefinedTypeMethodAsyncCallback,
-                                      this,
-                                      callId++,
-                                      in1,
-                                      in2,
-                                      std::placeholders::_1,
-                                      std::placeholders::_2,
-                                      std::placeholders::_3));
+
+    void report(std::chrono::microseconds _elapsed,
+                uint64_t _sent, uint64_t _succeeded, uint64_t _failed,
+                const LatencyHistogram& _histogram) {
+        const double elapsedSeconds = double(_elapsed.count()) / 1000000.0;
+        const ::testing::TestInfo* testInfo = ::testing::UnitTest::GetInstance()->current_test_info();
+
+        std::ostringstream json;
+        json << "{\"test\":\"" << testInfo->name() << "\""
+             << ",\"proxies\":" << configuration_.proxies
+             << ",\"connections\":" << configuration_.connections
+             << ",\"services\":" << configuration_.services
+             << ",\"window\":" << configuration_.window
+             << ",\"payloadSize\":" << configuration_.payloadSize
+             << ",\"syncPercent\":" << configuration_.syncPercent
+             << ",\"durationMs\":" << configuration_.durationMs
+             << ",\"callsPerProxy\":" << configuration_.callsPerProxy
+             << ",\"sent\":" << _sent
+             << ",\"succeeded\":" << _succeeded
+             << ",\"failed\":" << _failed
+             << ",\"elapsedMs\":" << double(_elapsed.count()) / 1000.0
+             << ",\"callsPerSecond\":" << (elapsedSeconds > 0 ? double(_succeeded) / elapsedSeconds : 0.0)
+             << ",\"latencyUs\":{"
+             << "\"min\":" << _histogram.getMinUs()
+             << ",\"mean\":" << _histogram.getMeanUs()
+             << ",\"p50\":" << _histogram.getPercentileUs(0.5)
+             << ",\"p99\":" << _histogram.getPercentileUs(0.99)
+             << ",\"p999\":" << _histogram.getPercentileUs(0.999)
+             << ",\"max\":" << _histogram.getMaxUs()
+             << "}}";
+
+        std::cout << json.str() << std::endl;
+
+        const char* reportFile = std::getenv("COMMONAPI_DBUS_LOAD_REPORT");
+        if (reportFile) {
+            std::ofstream report(reportFile, std::ios::app);
+            report << json.str() << std::endl;
         }
     }
 
-    bool allCallsSucceeded = false;
-    for (auto i = 0; !allCallsSucceeded && i < 100; ++i) {
-        allCallsSucceeded = std::all_of(callSucceeded_.cbegin(), callSucceeded_.cend(), [](int b){ return b; });
-        if (!allCallsSucceeded)
-            std::this_thread::sleep_for(std::chrono::microseconds(100000));
+    std::string getServiceAddress(uint32_t _service) const {
+        return serviceAddress_ + std::to_string(_service);
     }
-    ASSERT_TRUE(allCallsSucceeded);
 
-    for (unsigned int i = 0; i < numProxies_; i++) {
-        runtime_->unregisterService(domain_, testStubs[i]->getStubAdapter()->getInterface(), serviceAddress_ + std::to_string(i));
-    }
+    std::shared_ptr<CommonAPI::Runtime> runtime_;
+    LoadConfiguration configuration_;
+
+    static const std::string domain_;
+    static const std::string serviceAddress_;
+    static const uint32_t defaultNumCallsPerProxy_;
+    static const uint32_t defaultNumProxies_;
+};
+
+const std::string DBusLoadTest::domain_ = "local";
+const std::string DBusLoadTest::serviceAddress_ = "CommonAPI.DBus.tests.DBusProxyTestService";
+const uint32_t DBusLoadTest::defaultNumCallsPerProxy_ = 100;
+
+#ifdef _WIN32
+// test with just 50 proxies under windows as it becomes very slow with more ones
+const uint32_t DBusLoadTest::defaultNumProxies_ = 50;
+#else
+const uint32_t DBusLoadTest::defaultNumProxies_ = 65;
+#endif
+
+// Multiple proxies on one connection, one stub
+TEST_F(DBusLoadTest, SingleClientMultipleProxiesSingleStubCallsSucceed) {
+    runLoad();
+}
+
+// Multiple proxies on separate connections, one stub
+TEST_F(DBusLoadTest, MultipleClientsSingleStubCallsSucceed) {
+    configuration_.connections = 0;
+    runLoad();
+}
+
+// Multiple proxies on separate connections, multiple stubs on separate connections
+TEST_F(DBusLoadTest, MultipleClientsMultipleServersCallsSucceed) {
+    configuration_.connections = 0;
+    configuration_.services = 0;
+    runLoad();
+}
+
+// Mixed sync/async calls with a bounded in-flight window and a larger payload
+TEST_F(DBusLoadTest, MixedSyncAsyncWindowedCallsSucceed) {
+    configuration_.proxies = 8;
+    configuration_.connections = 4;
+    configuration_.window = 8;
+    configuration_.payloadSize = 4096;
+    configuration_.syncPercent = 25;
+    runLoad();
 }
 
 #ifndef __NO_MAIN__
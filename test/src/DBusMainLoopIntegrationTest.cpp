@@ -5,6 +5,7 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <iostream>
@@ -12,6 +13,7 @@
 #include <memory>
 #include <stdint.h>
 #include <string>
+#include <thread>
 #include <utility>
 #include <tuple>
 #include <type_traits>
@@ -30,6 +32,10 @@
 
 #include "DBusTestUtils.hpp"
 #include "DemoMainLoop.hpp"
+#ifdef __linux__
+#include "EpollMainLoop.hpp"
+#include <sys/resource.h>
+#endif
 
 #include "commonapi/tests/PredefinedTypeCollection.hpp"
 #include "commonapi/tests/DerivedTypeCollection.hpp"
@@ -48,6 +54,7 @@ const std::string testAddress5 = "commonapi.address.five";
 const std::string testAddress6 = "commonapi.address.six";
 const std::string testAddress7 = "commonapi.address.seven";
 const std::string testAddress8 = "commonapi.address.eight";
+const std::string testAddress9 = "commonapi.address.nine";
 
 #define VERSION v1_0
 
@@ -268,6 +275,368 @@ TEST_F(DBusMainLoopTest, DemoMainloopClientsHandleNonavailableServices) {
     ASSERT_EQ(toString(CommonAPI::CallStatus::NOT_AVAILABLE), toString(futureStatus.get()));
 }
 
+//##################################################################################################
+#ifdef __linux__
+class DBusEpollMainLoopTest: public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        runtime_ = CommonAPI::Runtime::get();
+        ASSERT_TRUE((bool) runtime_);
+
+        context_ = std::make_shared<CommonAPI::MainLoopContext>();
+        ASSERT_TRUE((bool) context_);
+        mainLoop_ = new CommonAPI::EpollMainLoop(context_);
+    }
+
+    virtual void TearDown() {
+        delete mainLoop_;
+    }
+
+    std::shared_ptr<CommonAPI::Runtime> runtime_;
+    std::shared_ptr<CommonAPI::MainLoopContext> context_;
+    CommonAPI::EpollMainLoop* mainLoop_;
+};
+
+TEST_F(DBusEpollMainLoopTest, PrioritiesAreHandledCorrectlyInEpollMainloop) {
+    std::string result = "";
+
+    TestSource* testSource1Default = new TestSource("A", result);
+    TestSource* testSource2Default = new TestSource("B", result);
+    TestSource* testSource1High = new TestSource("C", result);
+    TestSource* testSource1Low = new TestSource("D", result);
+    TestSource* testSource1VeryHigh = new TestSource("E", result);
+    context_->registerDispatchSource(testSource1Default);
+    context_->registerDispatchSource(testSource2Default, CommonAPI::DispatchPriority::DEFAULT);
+    context_->registerDispatchSource(testSource1High, CommonAPI::DispatchPriority::HIGH);
+    context_->registerDispatchSource(testSource1Low, CommonAPI::DispatchPriority::LOW);
+    context_->registerDispatchSource(testSource1VeryHigh, CommonAPI::DispatchPriority::VERY_HIGH);
+
+    mainLoop_->wakeup();
+    mainLoop_->doSingleIteration(CommonAPI::TIMEOUT_INFINITE);
+
+    std::string reference1("ECABD");
+    std::string reference2("ECBAD");
+    ASSERT_TRUE(reference1 == result || reference2 == result);
+}
+
+TEST_F(DBusEpollMainLoopTest, ProxyAndServiceInSameEpollMainloopCanCommunicate) {
+    std::shared_ptr<VERSION::commonapi::tests::TestInterfaceStubDefault> stub = std::make_shared<
+        VERSION::commonapi::tests::TestInterfaceStubDefault>();
+    ASSERT_TRUE(runtime_->registerService(domain, testAddress8, stub, context_));
+
+    auto proxy = runtime_->buildProxy<VERSION::commonapi::tests::TestInterfaceProxy>(domain, testAddress8, context_);
+    ASSERT_TRUE((bool) proxy);
+
+    while (!proxy->isAvailable()) {
+        mainLoop_->doSingleIteration(50);
+    }
+
+    uint32_t uint32Value = 42;
+    std::string stringValue = "Hai :)";
+
+    std::future<CommonAPI::CallStatus> futureStatus = proxy->testVoidPredefinedTypeMethodAsync(
+                    uint32Value,
+                    stringValue,
+                    [&] (const CommonAPI::CallStatus& status) {
+                        EXPECT_EQ(toString(CommonAPI::CallStatus::SUCCESS), toString(status));
+                        mainLoop_->stop();
+                    }
+    );
+
+    mainLoop_->run();
+
+    ASSERT_EQ(toString(CommonAPI::CallStatus::SUCCESS), toString(futureStatus.get()));
+
+    runtime_->unregisterService(domain, stub->getStubAdapter()->getInterface(), testAddress8);
+}
+
+struct CountingTimeout: public CommonAPI::Timeout {
+    CountingTimeout(int64_t interval, std::atomic<uint32_t>& count)
+        : interval_(interval), readyTime_(CommonAPI::getCurrentTimeInMs() + interval), count_(count) {}
+
+    bool dispatch() {
+        count_++;
+        readyTime_ = CommonAPI::getCurrentTimeInMs() + interval_;
+        return true;
+    }
+    int64_t getTimeoutInterval() const {
+        return interval_;
+    }
+    int64_t getReadyTime() const {
+        return readyTime_;
+    }
+
+ private:
+    int64_t interval_;
+    int64_t readyTime_;
+    std::atomic<uint32_t>& count_;
+};
+
+struct CountingWatch: public CommonAPI::Watch {
+    CountingWatch(int fd, std::atomic<uint32_t>& count): count_(count) {
+        fileDescriptor_.fd = fd;
+        fileDescriptor_.events = POLLIN;
+        fileDescriptor_.revents = 0;
+    }
+
+    void dispatch(unsigned int eventFlags) {
+        (void)eventFlags;
+        uint64_t value;
+        if (::read(fileDescriptor_.fd, &value, sizeof(value)) == sizeof(value)) {
+            count_++;
+        }
+    }
+    const pollfd& getAssociatedFileDescriptor() {
+        return fileDescriptor_;
+    }
+    const std::vector<CommonAPI::DispatchSource*>& getDependentDispatchSources() {
+        return dependentSources_;
+    }
+
+ private:
+    pollfd fileDescriptor_;
+    std::vector<CommonAPI::DispatchSource*> dependentSources_;
+    std::atomic<uint32_t>& count_;
+};
+
+TEST_F(DBusEpollMainLoopTest, TimeoutsAreDispatchedRepeatedlyInEpollMainloop) {
+    std::atomic<uint32_t> shortCount(0);
+    std::atomic<uint32_t> longCount(0);
+    context_->registerTimeoutSource(new CountingTimeout(10, shortCount));
+    context_->registerTimeoutSource(new CountingTimeout(3600000, longCount));
+
+    auto start = std::chrono::steady_clock::now();
+    while (shortCount < 5 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        mainLoop_->doSingleIteration(CommonAPI::TIMEOUT_INFINITE);
+    }
+
+    ASSERT_EQ(5u, shortCount.load());
+    ASSERT_EQ(0u, longCount.load());
+}
+
+/*
+ * Cost of one main loop iteration with one ready watch while a growing number of
+ * idle watches and pending timeouts (as created by many proxies) is registered.
+ */
+template<class _MainLoop>
+static double measureMainLoopIteration(size_t _numIdle, uint32_t _iterations) {
+    std::shared_ptr<CommonAPI::MainLoopContext> context = std::make_shared<CommonAPI::MainLoopContext>();
+    std::vector<int> fileDescriptors;
+    std::atomic<uint32_t> idleCount(0);
+    std::atomic<uint32_t> activeCount(0);
+    double nsPerIteration = -1.0;
+
+    {
+        _MainLoop mainLoop(context);
+
+        for (size_t i = 0; i < _numIdle; i++) {
+            int fd = eventfd(0, EFD_NONBLOCK);
+            if (fd == -1) {
+                break;
+            }
+            fileDescriptors.push_back(fd);
+            context->registerWatch(new CountingWatch(fd, idleCount));
+            context->registerTimeoutSource(new CountingTimeout(3600000, idleCount));
+        }
+
+        int activeFd = eventfd(0, EFD_NONBLOCK);
+        if (fileDescriptors.size() == _numIdle && activeFd != -1) {
+            fileDescriptors.push_back(activeFd);
+            context->registerWatch(new CountingWatch(activeFd, activeCount));
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < _iterations; i++) {
+                uint64_t value = 1;
+                if (::write(activeFd, &value, sizeof(value)) != sizeof(value)) {
+                    break;
+                }
+                mainLoop.doSingleIteration(CommonAPI::TIMEOUT_INFINITE);
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            if (activeCount == _iterations) {
+                nsPerIteration = double(elapsed.count()) / _iterations;
+            }
+        } else if (activeFd != -1) {
+            ::close(activeFd);
+        }
+    }
+
+    for (auto fd : fileDescriptors) {
+        ::close(fd);
+    }
+    EXPECT_EQ(0u, idleCount.load());
+    return nsPerIteration;
+}
+
+TEST_F(DBusBasicMainLoopTest, EpollMainloopIterationCostComparedToDemoMainloop) {
+    // Each idle watch needs its own descriptor
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    const std::vector<std::pair<size_t, uint32_t>> runs = { { 16, 10000 }, { 256, 1000 }, { 1024, 100 }, { 4096, 20 } };
+    for (auto &run : runs) {
+        double demoNs = measureMainLoopIteration<CommonAPI::MainLoop>(run.first, run.second);
+        double epollNs = measureMainLoopIteration<CommonAPI::EpollMainLoop>(run.first, run.second);
+        if (demoNs < 0 || epollNs < 0) {
+            std::cout << "[ BENCH    ] " << run.first << " idle watches/timeouts: skipped (out of file descriptors)" << std::endl;
+            continue;
+        }
+        std::cout << "[ BENCH    ] " << run.first << " idle watches/timeouts: "
+                  << "DemoMainLoop " << demoNs << " ns/iteration, "
+                  << "EpollMainLoop " << epollNs << " ns/iteration" << std::endl;
+    }
+}
+
+/*
+ * Dispatch source that stays ready for a number of dispatches and records how many
+ * threads are inside its dispatch() at the same time.
+ */
+struct BlockingSource: public CommonAPI::DispatchSource {
+    BlockingSource(uint32_t dispatches, std::chrono::milliseconds duration)
+        : remaining_(dispatches), duration_(duration), active_(0), maxActive_(0), dispatched_(0) {}
+
+    bool prepare(int64_t& timeout) {
+        timeout = CommonAPI::TIMEOUT_INFINITE;
+        return remaining_ > 0;
+    }
+    bool check() {
+        return remaining_ > 0;
+    }
+    bool dispatch() {
+        uint32_t active = ++active_;
+        uint32_t maxActive = maxActive_;
+        while (active > maxActive && !maxActive_.compare_exchange_weak(maxActive, active));
+        std::this_thread::sleep_for(duration_);
+        remaining_--;
+        dispatched_++;
+        active_--;
+        return false;
+    }
+
+    std::atomic<uint32_t> remaining_;
+    std::chrono::milliseconds duration_;
+    std::atomic<uint32_t> active_;
+    std::atomic<uint32_t> maxActive_;
+    std::atomic<uint32_t> dispatched_;
+};
+
+class DBusPooledEpollMainLoopTest: public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        runtime_ = CommonAPI::Runtime::get();
+        ASSERT_TRUE((bool) runtime_);
+
+        serviceContext_ = std::make_shared<CommonAPI::MainLoopContext>("connection.service");
+        clientContext_ = std::make_shared<CommonAPI::MainLoopContext>("connection.client");
+        mainLoop_ = new CommonAPI::EpollMainLoop(serviceContext_, 4);
+        mainLoop_->attachContext(clientContext_);
+    }
+
+    virtual void TearDown() {
+        delete mainLoop_;
+    }
+
+    std::shared_ptr<CommonAPI::Runtime> runtime_;
+    std::shared_ptr<CommonAPI::MainLoopContext> serviceContext_;
+    std::shared_ptr<CommonAPI::MainLoopContext> clientContext_;
+    CommonAPI::EpollMainLoop* mainLoop_;
+};
+
+TEST_F(DBusPooledEpollMainLoopTest, SlowDispatchSourceDoesNotStallOtherContexts) {
+    BlockingSource* slowSource = new BlockingSource(3, std::chrono::milliseconds(200));
+    BlockingSource* fastSource = new BlockingSource(20, std::chrono::milliseconds(0));
+    serviceContext_->registerDispatchSource(slowSource);
+    clientContext_->registerDispatchSource(fastSource);
+
+    auto start = std::chrono::steady_clock::now();
+    while (fastSource->remaining_ > 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        mainLoop_->doSingleIteration(10);
+    }
+    ASSERT_EQ(20u, fastSource->dispatched_.load());
+    EXPECT_LT(slowSource->dispatched_.load(), 3u);
+
+    while (slowSource->remaining_ > 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        mainLoop_->doSingleIteration(10);
+    }
+    ASSERT_EQ(3u, slowSource->dispatched_.load());
+
+    // A dispatch source is never handed to two workers at once: this is what keeps
+    // the messages of one connection in order.
+    EXPECT_EQ(1u, slowSource->maxActive_.load());
+    EXPECT_EQ(1u, fastSource->maxActive_.load());
+}
+
+TEST_F(DBusPooledEpollMainLoopTest, WatchesAndTimeoutsAreDispatchedByWorkers) {
+    std::atomic<uint32_t> timeoutCount(0);
+    std::atomic<uint32_t> watchCount(0);
+    int fd = eventfd(0, EFD_NONBLOCK);
+    ASSERT_NE(-1, fd);
+
+    // The counters live on this stack frame, so the test must not return early
+    // while the workers may still dispatch the sources.
+    serviceContext_->registerTimeoutSource(new CountingTimeout(10, timeoutCount));
+    clientContext_->registerWatch(new CountingWatch(fd, watchCount));
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 1; i <= 5; i++) {
+        uint64_t value = 1;
+        EXPECT_EQ(ssize_t(sizeof(value)), ::write(fd, &value, sizeof(value)));
+        while (watchCount < i && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+            mainLoop_->doSingleIteration(10);
+        }
+    }
+    while (timeoutCount < 3 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        mainLoop_->doSingleIteration(10);
+    }
+
+    delete mainLoop_;
+    mainLoop_ = NULL;
+    ::close(fd);
+
+    ASSERT_EQ(5u, watchCount.load());
+    ASSERT_GE(timeoutCount.load(), 3u);
+}
+
+TEST_F(DBusPooledEpollMainLoopTest, ProxyAndServiceOnDifferentConnectionsCanCommunicate) {
+    std::shared_ptr<VERSION::commonapi::tests::TestInterfaceStubDefault> stub = std::make_shared<
+        VERSION::commonapi::tests::TestInterfaceStubDefault>();
+    ASSERT_TRUE(runtime_->registerService(domain, testAddress9, stub, serviceContext_));
+
+    auto proxy = runtime_->buildProxy<VERSION::commonapi::tests::TestInterfaceProxy>(domain, testAddress9, clientContext_);
+    ASSERT_TRUE((bool) proxy);
+
+    std::thread loopThread([&]() { mainLoop_->run(50); });
+
+    // No ASSERT_* until the loop thread is joined, leaving the test with a joinable
+    // thread terminates the process.
+    for (int i = 0; !proxy->isAvailable() && i < 100; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    EXPECT_TRUE(proxy->isAvailable());
+
+    if (proxy->isAvailable()) {
+        uint32_t uint32Value = 42;
+        std::string stringValue = "Hai :)";
+
+        std::vector<std::future<CommonAPI::CallStatus>> futures;
+        for (int i = 0; i < 100; i++) {
+            futures.push_back(proxy->testVoidPredefinedTypeMethodAsync(uint32Value, stringValue));
+        }
+        for (auto &future : futures) {
+            EXPECT_EQ(toString(CommonAPI::CallStatus::SUCCESS), toString(future.get()));
+        }
+    }
+
+    mainLoop_->stop();
+    loopThread.join();
+
+    runtime_->unregisterService(domain, stub->getStubAdapter()->getInterface(), testAddress9);
+}
+#endif
+
 //##################################################################################################
 #ifndef _WIN32
 class GDispatchWrapper: public GSource {
@@ -33,7 +33,12 @@
 #include <gtest/gtest.h>
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include <pugixml/pugixml.hpp>
 
@@ -974,6 +979,57 @@ TEST_F(DBusManagedTest, PropagateTeardown) {
     proxyConnection->disconnect();
 }
 
+TEST_F(DBusManagedTest, PropagateTeardownOfManyLeafs) {
+    size_t numberOfLeafs = 1000;
+    if (const char *leafs = getenv("COMMONAPI_DBUS_MANAGED_INSTANCES")) {
+        numberOfLeafs = static_cast<size_t>(strtoul(leafs, nullptr, 10));
+    }
+
+    auto rootStub = std::make_shared<VERSION::commonapi::tests::managed::RootInterfaceStubDefault>();
+    ASSERT_TRUE(runtime_->registerService(domain, rootInstanceName, rootStub, serviceConnectionId));
+
+    auto leafStub = std::make_shared<VERSION::commonapi::tests::managed::LeafInterfaceStubDefault>();
+    for (size_t i = 0; i < numberOfLeafs; i++) {
+        ASSERT_TRUE(rootStub->registerManagedStubLeafInterface(leafStub, leafInstanceNameRoot + std::to_string(i)));
+    }
+
+    auto dbusObjectPathAndInterfacesDict = getManagedObjects(rootDbusServiceName, rootDbusObjectPath, manualDBusConnection_);
+    ASSERT_EQ(numberOfLeafs, dbusObjectPathAndInterfacesDict.size());
+
+    //deregistering a single leaf does not touch the others
+    ASSERT_TRUE(rootStub->deregisterManagedStubLeafInterface(leafInstanceNameRoot + "0"));
+    ASSERT_FALSE(rootStub->deregisterManagedStubLeafInterface(leafInstanceNameRoot + "0"));
+    ASSERT_EQ(numberOfLeafs - 1, rootStub->getStubAdapter()->getLeafInterfaceInstances().size());
+
+    auto start = std::chrono::steady_clock::now();
+    rootStub->getStubAdapter()->deactivateManagedInstances();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    printf("[ BENCH    ] teardown of %zu leafs: %.3f ms, %.1f us/leaf\n",
+           numberOfLeafs - 1,
+           double(elapsed.count()) / 1000.0,
+           double(elapsed.count()) / double(numberOfLeafs - 1));
+    fflush(stdout);
+
+    ASSERT_TRUE(rootStub->getStubAdapter()->getLeafInterfaceInstances().empty());
+
+    //check that root no longer manages any leaf
+    dbusObjectPathAndInterfacesDict.clear();
+    dbusObjectPathAndInterfacesDict = getManagedObjects(rootDbusServiceName, rootDbusObjectPath, manualDBusConnection_);
+    ASSERT_TRUE(dbusObjectPathAndInterfacesDict.empty());
+
+    //leafs can be registered again after the teardown
+    ASSERT_TRUE(rootStub->registerManagedStubLeafInterface(leafStub, leafInstanceNameRoot));
+    ASSERT_TRUE(rootStub->deregisterManagedStubLeafInterface(leafInstanceNameRoot));
+
+    runtime_->unregisterService(domain, VERSION::commonapi::tests::managed::RootInterfaceStubDefault::StubInterface::getInterface(), rootInstanceName);
+
+    //check that root is unregistered
+    dbusObjectPathAndInterfacesDict.clear();
+    dbusObjectPathAndInterfacesDict = getManagedObjects(rootDbusServiceName, "/", manualDBusConnection_);
+    ASSERT_TRUE(dbusObjectPathAndInterfacesDict.empty());
+}
+
 class DBusManagedTestExtended: public DBusManagedTest {
 protected:
     virtual void SetUp() {
@@ -1800,6 +1856,67 @@ TEST_F(DBusManagedTestExtended, RegisterLeafsWithAutoGeneratedInstanceIds)
     ASSERT_TRUE(dbusObjectPathAndInterfacesDict.empty());
 }
 
+TEST_F(DBusManagedTestExtended, RegisterManyLeafsInBatch)
+{
+    const size_t numberOfLeafs = 100;
+    const size_t numberOfSingleLeafs = 10;
+
+    auto rootStub = std::make_shared<VERSION::commonapi::tests::managed::RootInterfaceStubDefault>();
+    ASSERT_TRUE(runtime_->registerService(domain, rootInstanceName, rootStub, serviceConnectionId));
+
+    auto rootStubAdapter = std::dynamic_pointer_cast<
+            VERSION::commonapi::tests::managed::RootInterfaceDBusStubAdapterInternal<VERSION::commonapi::tests::managed::RootInterfaceStub>>(
+                    rootStub->getStubAdapter());
+    ASSERT_TRUE((bool)rootStubAdapter);
+
+    std::vector<std::pair<std::string, std::shared_ptr<VERSION::commonapi::tests::managed::LeafInterfaceStub>>> leafs;
+    for (size_t i = 0; i < numberOfLeafs; i++) {
+        leafs.emplace_back(leafInstanceNameRoot + std::to_string(i),
+                           std::make_shared<VERSION::commonapi::tests::managed::LeafInterfaceStubDefault>());
+    }
+
+    // the first leafs are registered one by one
+    for (size_t i = 0; i < numberOfSingleLeafs; i++) {
+        ASSERT_TRUE(rootStub->registerManagedStubLeafInterface(leafs[i].second, leafs[i].first));
+    }
+
+    auto dbusObjectPathAndInterfacesDict = getManagedObjects(rootDbusServiceName, rootDbusObjectPath, manualDBusConnection_);
+    ASSERT_EQ(numberOfSingleLeafs, dbusObjectPathAndInterfacesDict.size());
+
+    // the batch skips them and registers all others
+    ASSERT_EQ(numberOfLeafs - numberOfSingleLeafs, rootStubAdapter->registerManagedStubLeafInterfaceBatch(leafs));
+
+    dbusObjectPathAndInterfacesDict.clear();
+    dbusObjectPathAndInterfacesDict = getManagedObjects(rootDbusServiceName, rootDbusObjectPath, manualDBusConnection_);
+    ASSERT_EQ(numberOfLeafs, dbusObjectPathAndInterfacesDict.size());
+    for (size_t i = 0; i < numberOfLeafs; i++) {
+        ASSERT_TRUE(isManaged(leafDbusObjectPathRoot + std::to_string(i), leafDbusInterfaceName, dbusObjectPathAndInterfacesDict));
+    }
+
+    // a batch of registered instances registers nothing
+    ASSERT_EQ(0u, rootStubAdapter->registerManagedStubLeafInterfaceBatch(leafs));
+
+    dbusObjectPathAndInterfacesDict.clear();
+    dbusObjectPathAndInterfacesDict = getManagedObjects(rootDbusServiceName, rootDbusObjectPath, manualDBusConnection_);
+    ASSERT_EQ(numberOfLeafs, dbusObjectPathAndInterfacesDict.size());
+
+    // and each of them can be deregistered on its own
+    ASSERT_TRUE(rootStub->deregisterManagedStubLeafInterface(leafs[0].first));
+    ASSERT_TRUE(rootStub->deregisterManagedStubLeafInterface(leafs[numberOfLeafs - 1].first));
+
+    dbusObjectPathAndInterfacesDict.clear();
+    dbusObjectPathAndInterfacesDict = getManagedObjects(rootDbusServiceName, rootDbusObjectPath, manualDBusConnection_);
+    ASSERT_EQ(numberOfLeafs - 2, dbusObjectPathAndInterfacesDict.size());
+    ASSERT_FALSE(isManaged(leafDbusObjectPathRoot + "0", leafDbusInterfaceName, dbusObjectPathAndInterfacesDict));
+
+    rootStub->getStubAdapter()->deactivateManagedInstances();
+    dbusObjectPathAndInterfacesDict.clear();
+    dbusObjectPathAndInterfacesDict = getManagedObjects(rootDbusServiceName, rootDbusObjectPath, manualDBusConnection_);
+    ASSERT_TRUE(dbusObjectPathAndInterfacesDict.empty());
+
+    runtime_->unregisterService(domain, VERSION::commonapi::tests::managed::RootInterfaceStubDefault::StubInterface::getInterface(), rootInstanceName);
+}
+
 TEST_F(DBusManagedTestExtended, RegisterLeafsWithAutoGeneratedInstanceIdsAndCommunicate)
 {
     auto rootStub = std::make_shared<VERSION::commonapi::tests::managed::RootInterfaceStubDefault>();
@@ -3,6 +3,8 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
+#include <cstring>
+
 #include <dbus/dbus.h>
 #include <gtest/gtest.h>
 
@@ -18,6 +20,7 @@
 #include <CommonAPI/Variant.hpp>
 
 #include "commonapi/tests/DerivedTypeCollection.hpp"
+#include "commonapi/tests/DerivedTypeCollectionDBusDeployment.hpp"
 
 class OutputStreamTest: public ::testing::Test {
 protected:
@@ -847,6 +850,32 @@ TEST_F(OutputStreamTest, WritesEnumKeyedMaps) {
     }
 }
 
+TEST_F(OutputStreamTest, WireLayoutWritesFixedSizeStructsLikeTheStream) {
+    typedef ::commonapi::tests::DerivedTypeCollection_::TestFixedSizeStructLayout_t Layout;
+
+    //1(uint8_t) + 7(padding) + 8(double) + 4(bool) + 2(int16_t)
+    static_assert(Layout::size == 22, "TestFixedSizeStruct is 22 bytes on the wire");
+
+    const char signature[] = "(ydbn)";
+    message = CommonAPI::DBus::DBusMessage::createMethodCall(CommonAPI::DBus::DBusAddress(busName, objectPath, interfaceName), methodName, signature);
+    CommonAPI::DBus::DBusOutputStream outStream(message);
+
+    ::commonapi::tests::DerivedTypeCollection::TestFixedSizeStruct testStruct(0x5a, 3.414, true, -42);
+    outStream << testStruct;
+    outStream.flush();
+
+    ASSERT_EQ(size_t(Layout::size), size_t(message.getBodyLength()));
+
+    char body[Layout::size];
+    memset(body, 0, sizeof(body));
+    Layout::write(body, testStruct);
+    EXPECT_EQ(0, memcmp(body, message.getBodyData(), Layout::size));
+
+    ::commonapi::tests::DerivedTypeCollection::TestFixedSizeStruct verifyStruct;
+    Layout::read(message.getBodyData(), verifyStruct);
+    EXPECT_EQ(testStruct, verifyStruct);
+}
+
 #ifndef __NO_MAIN__
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,142 @@
+// Copyright (C) 2015 Bayerische Motoren Werke Aktiengesellschaft (BMW AG)
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef _GLIBCXX_USE_NANOSLEEP
+#define _GLIBCXX_USE_NANOSLEEP
+#endif
+
+#include <CommonAPI/CommonAPI.hpp>
+
+#ifndef COMMONAPI_INTERNAL_COMPILATION
+#define COMMONAPI_INTERNAL_COMPILATION
+#endif
+
+#include <CommonAPI/DBus/DBusConnection.hpp>
+#include <CommonAPI/DBus/DBusAddress.hpp>
+
+#include <v1/test/pipeline/TestInterfaceDBusProxy.hpp>
+#include <v1/test/pipeline/TestInterfaceStubDefault.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const std::string domain = "local";
+static const std::string commonApiAddress = "CommonAPI.DBus.tests.DBusPipelineTestService";
+static const std::string interfaceName = "test.pipeline.TestInterface.v1_0";
+static const std::string busName = "test.pipeline.TestInterface_CommonAPI.DBus.tests.DBusPipelineTestService";
+static const std::string objectPath = "/CommonAPI/DBus/tests/DBusPipelineTestService";
+
+#define VERSION v1_0
+
+// The deployment (pipeline.fdepl) allows 16 pending calls and queues up to 1024 further ones.
+class PipelineTest: public ::testing::Test {
+
+protected:
+    void SetUp() {
+        runtime_ = CommonAPI::Runtime::get();
+
+        proxyDBusConnection_ = CommonAPI::DBus::DBusConnection::getBus(CommonAPI::DBus::DBusType_t::SESSION, "clientConnection");
+        ASSERT_TRUE(proxyDBusConnection_->connect());
+
+        proxy_ = std::make_shared<VERSION::test::pipeline::TestInterfaceDBusProxy>(
+            CommonAPI::DBus::DBusAddress(busName, objectPath, interfaceName),
+                        proxyDBusConnection_);
+        proxy_->init();
+
+        stubDefault_ = std::make_shared<VERSION::test::pipeline::TestInterfaceStubDefault>();
+        ASSERT_TRUE((runtime_->registerService<VERSION::test::pipeline::TestInterfaceStub>(domain, commonApiAddress, stubDefault_, "serviceConnection")));
+
+        for (int i = 0; !proxy_->isAvailable() && i < 100; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ASSERT_TRUE(proxy_->isAvailable());
+    }
+
+    virtual void TearDown() {
+        proxy_.reset();
+        ASSERT_TRUE(runtime_->unregisterService(domain, stubDefault_->getStubAdapter()->getInterface(), commonApiAddress));
+        stubDefault_.reset();
+        proxyDBusConnection_->disconnect();
+        std::this_thread::sleep_for(std::chrono::microseconds(300000));
+    }
+
+    std::shared_ptr<CommonAPI::Runtime> runtime_;
+    std::shared_ptr<CommonAPI::DBus::DBusConnection> proxyDBusConnection_;
+    std::shared_ptr<VERSION::test::pipeline::TestInterfaceDBusProxy> proxy_;
+    std::shared_ptr<VERSION::test::pipeline::TestInterfaceStubDefault> stubDefault_;
+};
+
+TEST_F(PipelineTest, AsyncCallsBeyondTheInFlightWindowAreQueued) {
+    const uint32_t numberOfCalls = 200;
+    std::atomic<uint32_t> succeeded(0);
+    std::vector<std::future<CommonAPI::CallStatus>> futures;
+    std::size_t maxQueuedCalls = 0;
+    for (uint32_t i = 0; i < numberOfCalls; i++) {
+        futures.push_back(proxy_->testEmptyMethodAsync([&](const CommonAPI::CallStatus& callStatus) {
+            if (callStatus == CommonAPI::CallStatus::SUCCESS) {
+                succeeded++;
+            }
+        }));
+        maxQueuedCalls = std::max(maxQueuedCalls, proxy_->getQueuedCallCount());
+    }
+    for (auto &future : futures) {
+        EXPECT_EQ(CommonAPI::CallStatus::SUCCESS, future.get());
+    }
+    EXPECT_EQ(numberOfCalls, succeeded.load());
+    EXPECT_LT(0u, maxQueuedCalls);
+    EXPECT_EQ(0u, proxy_->getQueuedCallCount());
+    EXPECT_EQ(0u, proxy_->getRejectedCallCount());
+}
+
+TEST_F(PipelineTest, AsyncCallsBeyondTheQueueAreRejected) {
+    const uint32_t numberOfBurstCalls = 4000;
+    std::atomic<uint32_t> completed(0);
+    std::atomic<uint32_t> rejected(0);
+    std::vector<std::future<CommonAPI::CallStatus>> futures;
+    for (uint32_t i = 0; i < numberOfBurstCalls; i++) {
+        futures.push_back(proxy_->testEmptyMethodAsync([&](const CommonAPI::CallStatus& callStatus) {
+            if (callStatus == CommonAPI::CallStatus::OUT_OF_MEMORY) {
+                rejected++;
+            }
+            completed++;
+        }));
+    }
+    for (auto &future : futures) {
+        future.wait();
+    }
+    EXPECT_EQ(numberOfBurstCalls, completed.load());
+    EXPECT_EQ(rejected.load(), proxy_->getRejectedCallCount());
+}
+
+TEST_F(PipelineTest, QueuedCallsCompleteWhenTheProxyIsDestroyed) {
+    const uint32_t numberOfCalls = 500;
+    // Shared with the callbacks, which may still run if the test fails.
+    std::shared_ptr<std::atomic<uint32_t>> completed(std::make_shared<std::atomic<uint32_t>>(0));
+    std::vector<std::future<CommonAPI::CallStatus>> futures;
+    for (uint32_t i = 0; i < numberOfCalls; i++) {
+        futures.push_back(proxy_->testEmptyMethodAsync([completed](const CommonAPI::CallStatus&) {
+            (*completed)++;
+        }));
+    }
+    // Replies keep arriving and starting queued calls while the proxy goes away.
+    proxy_.reset();
+    for (auto &future : futures) {
+        ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(10)));
+    }
+    EXPECT_EQ(numberOfCalls, completed->load());
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
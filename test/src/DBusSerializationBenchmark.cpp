@@ -0,0 +1,208 @@
+// Copyright (C) 2015 Bayerische Motoren Werke Aktiengesellschaft (BMW AG)
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "AllocationCounter.hpp"
+
+#ifndef COMMONAPI_INTERNAL_COMPILATION
+#define COMMONAPI_INTERNAL_COMPILATION
+#endif
+
+#include <CommonAPI/DBus/DBusAddress.hpp>
+#include <CommonAPI/DBus/DBusMessage.hpp>
+#include <CommonAPI/DBus/DBusOutputStream.hpp>
+#include <CommonAPI/DBus/DBusInputStream.hpp>
+#include <CommonAPI/Variant.hpp>
+
+#include "commonapi/tests/DerivedTypeCollection.hpp"
+
+typedef CommonAPI::Variant<int8_t, uint32_t, double, std::string> BasicTypeVariant;
+
+// Payload sizes run from 16 B to 64 MB in steps of 4. The upper bound can be lowered
+// by setting COMMONAPI_DBUS_BENCHMARK_MAX_SIZE (in bytes).
+static const size_t minPayloadSize = 16;
+static const size_t maxPayloadSize = 64 * 1024 * 1024;
+
+// Every size is measured for at least this long and this many rounds.
+static const std::chrono::milliseconds minMeasurementTime(50);
+static const uint32_t minMeasurementRounds = 3;
+
+class SerializationBenchmark: public ::testing::Test {
+protected:
+    const char* busName;
+    const char* objectPath;
+    const char* interfaceName;
+    const char* methodName;
+    size_t maxSize;
+
+    void SetUp() {
+        busName = "no.bus.here";
+        objectPath = "/no/object/here";
+        interfaceName = "no.interface.here";
+        methodName = "noMethodHere";
+
+        maxSize = maxPayloadSize;
+        const char* maxSizeEnv = std::getenv("COMMONAPI_DBUS_BENCHMARK_MAX_SIZE");
+        if (maxSizeEnv) {
+            maxSize = std::strtoul(maxSizeEnv, NULL, 10);
+        }
+    }
+
+    void TearDown() {
+    }
+
+    std::vector<size_t> getPayloadSizes() const {
+        std::vector<size_t> sizes;
+        for (size_t size = minPayloadSize; size <= maxSize && size <= maxPayloadSize; size *= 4) {
+            sizes.push_back(size);
+        }
+        return sizes;
+    }
+
+    // Serializes and deserializes _value until enough samples are collected and prints
+    // ns/byte and allocations per message for both directions. Creating the message
+    // itself is not part of the measurement.
+    template<typename _Value>
+    void measure(const char* _shape, const char* _signature, size_t _targetSize, const _Value& _value) {
+        std::chrono::nanoseconds writeTime(0), readTime(0);
+        uint64_t writeAllocations(0), readAllocations(0);
+        size_t bodyLength(0);
+        uint32_t rounds(0);
+
+        while (rounds < minMeasurementRounds || writeTime + readTime < minMeasurementTime) {
+            CommonAPI::DBus::DBusMessage message = CommonAPI::DBus::DBusMessage::createMethodCall(
+                    CommonAPI::DBus::DBusAddress(busName, objectPath, interfaceName), methodName, _signature);
+            _Value result;
+
+            allocationCount = 0;
+            isCountingAllocations = true;
+            auto writeStart = std::chrono::steady_clock::now();
+            {
+                CommonAPI::DBus::DBusOutputStream outStream(message);
+                outStream.writeValue(_value, static_cast<CommonAPI::EmptyDeployment*>(nullptr));
+                outStream.flush();
+            }
+            auto writeEnd = std::chrono::steady_clock::now();
+            isCountingAllocations = false;
+            writeAllocations += allocationCount;
+            writeTime += std::chrono::duration_cast<std::chrono::nanoseconds>(writeEnd - writeStart);
+
+            allocationCount = 0;
+            isCountingAllocations = true;
+            auto readStart = std::chrono::steady_clock::now();
+            {
+                CommonAPI::DBus::DBusInputStream inStream(message);
+                inStream.readValue(result, static_cast<CommonAPI::EmptyDeployment*>(nullptr));
+                ASSERT_FALSE(inStream.hasError());
+            }
+            auto readEnd = std::chrono::steady_clock::now();
+            isCountingAllocations = false;
+            readAllocations += allocationCount;
+            readTime += std::chrono::duration_cast<std::chrono::nanoseconds>(readEnd - readStart);
+
+            bodyLength = message.getBodyLength();
+            rounds++;
+        }
+
+        ASSERT_GT(bodyLength, 0u);
+
+        const double totalBytes = double(bodyLength) * rounds;
+        printf("[ BENCH    ] %-16s %10zu B (body %10zu B, %6u rounds): "
+               "write %8.3f ns/byte %10.1f allocs/msg, read %8.3f ns/byte %10.1f allocs/msg\n",
+               _shape, _targetSize, bodyLength, rounds,
+               double(writeTime.count()) / totalBytes, double(writeAllocations) / rounds,
+               double(readTime.count()) / totalBytes, double(readAllocations) / rounds);
+        fflush(stdout);
+    }
+};
+
+TEST_F(SerializationBenchmark, Bytes) {
+    for (auto size : getPayloadSizes()) {
+        // 4(length field) + n(bytes)
+        std::vector<uint8_t> value(size - 4, 0xa5);
+        measure("ay", "ay", size, value);
+    }
+}
+
+TEST_F(SerializationBenchmark, Strings) {
+    for (auto size : getPayloadSizes()) {
+        // 4(length field) + n * (4(string length) + 11(string) + 1(terminating '\0'))
+        std::vector<std::string> value((size - 4) / 16, "Hello world");
+        measure("as", "as", size, value);
+    }
+}
+
+TEST_F(SerializationBenchmark, Structs) {
+    for (auto size : getPayloadSizes()) {
+        // 4(length field) + 4(padding) + n * (4(string length) + 9(string) + 1(terminating '\0') + 2(uint16_t))
+        size_t numOfElements = (size - 8) / 16;
+        ::commonapi::tests::DerivedTypeCollection::TestArrayTestStruct value(
+                numOfElements == 0 ? 1 : numOfElements,
+                ::commonapi::tests::DerivedTypeCollection::TestStruct("Hello all", 42));
+        measure("a(sq)", "a(sq)", size, value);
+    }
+}
+
+TEST_F(SerializationBenchmark, ArraysInArrays) {
+    for (auto size : getPayloadSizes()) {
+        // 4(length field) + n * (4(length field) + 4 * 4(int32_t))
+        size_t numOfElements = (size - 4) / 20;
+        std::vector<std::vector<int32_t>> value(numOfElements == 0 ? 1 : numOfElements,
+                                                std::vector<int32_t>(4, 0x7fffffff));
+        measure("aai", "aai", size, value);
+    }
+}
+
+TEST_F(SerializationBenchmark, Variants) {
+    for (auto size : getPayloadSizes()) {
+        // 4(length field) + 4(padding) + n * 16 on average over the four alternatives
+        size_t numOfElements = (size - 8) / 16;
+        std::vector<BasicTypeVariant> value;
+        value.reserve(numOfElements == 0 ? 1 : numOfElements);
+        for (size_t i = 0; i < numOfElements || value.empty(); i++) {
+            switch (i % 4) {
+            case 0: value.push_back(BasicTypeVariant(int8_t(7))); break;
+            case 1: value.push_back(BasicTypeVariant(uint32_t(42))); break;
+            case 2: value.push_back(BasicTypeVariant(13.37)); break;
+            default: value.push_back(BasicTypeVariant(std::string("Hai :)"))); break;
+            }
+        }
+        measure("a(yv)", "a(yv)", size, value);
+    }
+}
+
+TEST_F(SerializationBenchmark, EnumKeyedMaps) {
+    // The enumeration only has four literals, so the map grows by its values.
+    std::vector<::commonapi::tests::DerivedTypeCollection::TestEnum> keys = {
+            ::commonapi::tests::DerivedTypeCollection::TestEnum::E_NOT_USED,
+            ::commonapi::tests::DerivedTypeCollection::TestEnum::E_OK,
+            ::commonapi::tests::DerivedTypeCollection::TestEnum::E_OUT_OF_RANGE,
+            ::commonapi::tests::DerivedTypeCollection::TestEnum::E_UNKNOWN };
+
+    for (auto size : getPayloadSizes()) {
+        // 4(length field) + 4(padding) + 4 * (4(int32_t) + 4(string length) + n(string) + 1(terminating '\0') + padding)
+        size_t stringLength = size > 72 ? (size - 72) / 4 : 1;
+        ::commonapi::tests::DerivedTypeCollection::TestEnumMap value;
+        for (auto key : keys) {
+            value.insert({ key, std::string(stringLength, 'x') });
+        }
+        measure("a{is}", "a{is}", size, value);
+    }
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+#endif
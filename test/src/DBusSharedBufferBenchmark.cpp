@@ -0,0 +1,214 @@
+// Copyright (C) 2015 Bayerische Motoren Werke Aktiengesellschaft (BMW AG)
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "CommonAPI/CommonAPI.hpp"
+
+#ifndef COMMONAPI_INTERNAL_COMPILATION
+#define COMMONAPI_INTERNAL_COMPILATION
+#endif
+
+#include "CommonAPI/DBus/DBusConnection.hpp"
+
+#define VERSION v1_0
+
+#include <v1/commonapi/tests/TestInterfaceDBusProxy.hpp>
+#include <v1/commonapi/tests/TestInterfaceDBusStubAdapter.hpp>
+#include <v1/commonapi/tests/TestInterfaceStubDefault.hpp>
+
+static const std::string interfaceName = "commonapi.tests.TestInterface.v1_0";
+static const std::string busName = "commonapi.tests.TestInterface_CommonAPI.DBus.tests.DBusSharedBufferTestService";
+static const std::string objectPath = "/CommonAPI/DBus/tests/DBusSharedBufferTestService";
+
+// Payloads from 64 KB up to 64 MB are transferred. The upper limit can be lowered
+// by setting COMMONAPI_DBUS_BENCHMARK_MAX_SIZE (in bytes).
+static const size_t minPayloadSize = 64 * 1024;
+static const size_t maxPayloadSize = 64 * 1024 * 1024;
+
+// Every payload size transfers about this many bytes in total (at least four calls).
+// Set COMMONAPI_DBUS_BENCHMARK_BYTES (in bytes) for longer, more stable measurements.
+static const size_t defaultBytesPerMeasurement = 8 * 1024 * 1024;
+
+static uint32_t checksum(const CommonAPI::ByteBuffer& _buffer) {
+    uint32_t sum = 0;
+    for (uint8_t byte : _buffer) {
+        sum = sum * 31 + byte;
+    }
+    return sum;
+}
+
+class SharedBufferTestStub : public VERSION::commonapi::tests::TestInterfaceStubDefault {
+public:
+    void testBulkInBandMethod(const std::shared_ptr<CommonAPI::ClientId> _client,
+                              CommonAPI::ByteBuffer _bulkValue,
+                              testBulkInBandMethodReply_t _reply) {
+        (void)_client;
+        _reply(uint32_t(_bulkValue.size()), checksum(_bulkValue));
+    }
+
+    void testBulkSharedMethod(const std::shared_ptr<CommonAPI::ClientId> _client,
+                              CommonAPI::ByteBuffer _bulkValue,
+                              testBulkSharedMethodReply_t _reply) {
+        (void)_client;
+        _reply(uint32_t(_bulkValue.size()), checksum(_bulkValue));
+    }
+};
+
+class SharedBufferTest: public ::testing::Test {
+protected:
+    void SetUp() {
+        proxyDBusConnection_ = CommonAPI::DBus::DBusConnection::getBus(CommonAPI::DBus::DBusType_t::SESSION, "clientConnection");
+        ASSERT_TRUE(proxyDBusConnection_->connect());
+
+        proxy_ = std::make_shared<VERSION::commonapi::tests::TestInterfaceDBusProxy>(CommonAPI::DBus::DBusAddress(busName, objectPath, interfaceName), proxyDBusConnection_);
+        proxy_->init();
+
+        stubDBusConnection_ = CommonAPI::DBus::DBusConnection::getBus(CommonAPI::DBus::DBusType_t::SESSION, "serviceConnection");
+        ASSERT_TRUE(stubDBusConnection_->connect());
+
+        stub_ = std::make_shared<SharedBufferTestStub>();
+        stubAdapter_ = std::make_shared<VERSION::commonapi::tests::TestInterfaceDBusStubAdapter<VERSION::commonapi::tests::TestInterfaceStub>>(CommonAPI::DBus::DBusAddress(busName, objectPath, interfaceName), stubDBusConnection_, stub_);
+        stubAdapter_->init(stubAdapter_);
+
+        const bool isStubAdapterRegistered = CommonAPI::Runtime::get()->registerService(
+            stubAdapter_->getAddress().getDomain(), stubAdapter_->getAddress().getInstance(), stub_);
+        ASSERT_TRUE(isStubAdapterRegistered);
+
+        for (unsigned int i = 0; !proxy_->isAvailable() && i < 100; ++i) {
+            std::this_thread::sleep_for(std::chrono::microseconds(10000));
+        }
+        ASSERT_TRUE(proxy_->isAvailable());
+    }
+
+    void TearDown() {
+        const bool isStubAdapterUnregistered = CommonAPI::Runtime::get()->unregisterService(
+            stubAdapter_->getAddress().getDomain(), stubAdapter_->getInterface(), stubAdapter_->getAddress().getInstance());
+        ASSERT_TRUE(isStubAdapterUnregistered);
+        stubAdapter_.reset();
+
+        if (stubDBusConnection_->isConnected()) {
+            stubDBusConnection_->disconnect();
+        }
+        stubDBusConnection_.reset();
+
+        proxy_.reset();
+        if (proxyDBusConnection_->isConnected()) {
+            proxyDBusConnection_->disconnect();
+        }
+        proxyDBusConnection_.reset();
+        std::this_thread::sleep_for(std::chrono::microseconds(30000));
+    }
+
+    static CommonAPI::ByteBuffer createPayload(size_t _size) {
+        CommonAPI::ByteBuffer payload(_size);
+        for (size_t i = 0; i < _size; i++) {
+            payload[i] = uint8_t(i * 7 + (i >> 12));
+        }
+        return payload;
+    }
+
+    void callInBand(const CommonAPI::ByteBuffer& _payload, CommonAPI::CallStatus& _status, uint32_t& _size, uint32_t& _checksum) {
+        proxy_->testBulkInBandMethod(_payload, _status, _size, _checksum);
+    }
+
+    void callShared(const CommonAPI::ByteBuffer& _payload, CommonAPI::CallStatus& _status, uint32_t& _size, uint32_t& _checksum) {
+        proxy_->testBulkSharedMethod(_payload, _status, _size, _checksum);
+    }
+
+    template<typename _Call>
+    void measure(const char* _path, const CommonAPI::ByteBuffer& _payload, size_t _bytesPerMeasurement, _Call _call) {
+        const uint32_t expectedChecksum = checksum(_payload);
+        const uint32_t rounds = uint32_t(std::max(size_t(4), _bytesPerMeasurement / _payload.size()));
+        CommonAPI::CallStatus status;
+        uint32_t size(0);
+        uint32_t sum(0);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < rounds; i++) {
+            _call(_payload, status, size, sum);
+            ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, status);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        EXPECT_EQ(uint32_t(_payload.size()), size);
+        EXPECT_EQ(expectedChecksum, sum);
+
+        // Includes the checksum the service computes, which is the same for both paths.
+        const double seconds = double(elapsed.count()) / 1e9;
+        printf("[ BENCH    ] %-8s %10zu B (%5u calls): %10.1f us/call %10.1f MB/s\n",
+               _path, _payload.size(), rounds,
+               double(elapsed.count()) / rounds / 1000.0,
+               double(_payload.size()) * rounds / seconds / (1024.0 * 1024.0));
+        fflush(stdout);
+    }
+
+    std::shared_ptr<CommonAPI::DBus::DBusConnection> proxyDBusConnection_;
+    std::shared_ptr<VERSION::commonapi::tests::TestInterfaceDBusProxy> proxy_;
+
+    std::shared_ptr<CommonAPI::DBus::DBusConnection> stubDBusConnection_;
+    std::shared_ptr<VERSION::commonapi::tests::TestInterfaceDBusStubAdapter<VERSION::commonapi::tests::TestInterfaceStub>> stubAdapter_;
+    std::shared_ptr<SharedBufferTestStub> stub_;
+};
+
+TEST_F(SharedBufferTest, SharedBuffersAreTransferred) {
+    CommonAPI::CallStatus status;
+    uint32_t size(0);
+    uint32_t sum(0);
+
+    callShared(CommonAPI::ByteBuffer(), status, size, sum);
+    ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, status);
+    EXPECT_EQ(0u, size);
+    EXPECT_EQ(0u, sum);
+
+    const CommonAPI::ByteBuffer payload = createPayload(100003);
+    callShared(payload, status, size, sum);
+    ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, status);
+    EXPECT_EQ(uint32_t(payload.size()), size);
+    EXPECT_EQ(checksum(payload), sum);
+
+    callInBand(payload, status, size, sum);
+    ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, status);
+    EXPECT_EQ(uint32_t(payload.size()), size);
+    EXPECT_EQ(checksum(payload), sum);
+}
+
+TEST_F(SharedBufferTest, SharedBufferComparedToInBandTransfer) {
+    size_t maxSize = maxPayloadSize;
+    const char* maxSizeEnv = std::getenv("COMMONAPI_DBUS_BENCHMARK_MAX_SIZE");
+    if (maxSizeEnv) {
+        maxSize = std::strtoul(maxSizeEnv, NULL, 10);
+    }
+    size_t bytesPerMeasurement = defaultBytesPerMeasurement;
+    const char* bytesEnv = std::getenv("COMMONAPI_DBUS_BENCHMARK_BYTES");
+    if (bytesEnv) {
+        bytesPerMeasurement = std::strtoul(bytesEnv, NULL, 10);
+    }
+
+    for (size_t size = minPayloadSize; size <= maxSize; size *= 4) {
+        const CommonAPI::ByteBuffer payload = createPayload(size);
+        measure("in-band", payload, bytesPerMeasurement, [this](const CommonAPI::ByteBuffer& _payload, CommonAPI::CallStatus& _status,
+                                           uint32_t& _size, uint32_t& _checksum) {
+            callInBand(_payload, _status, _size, _checksum);
+        });
+        measure("shared", payload, bytesPerMeasurement, [this](const CommonAPI::ByteBuffer& _payload, CommonAPI::CallStatus& _status,
+                                          uint32_t& _size, uint32_t& _checksum) {
+            callShared(_payload, _status, _size, _checksum);
+        });
+    }
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+#endif
@@ -0,0 +1,71 @@
+// Copyright (C) 2015 Bayerische Motoren Werke Aktiengesellschaft (BMW AG)
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <dlfcn.h>
+
+#include <gtest/gtest.h>
+
+#include <CommonAPI/CommonAPI.hpp>
+
+#ifndef COMMONAPI_INTERNAL_COMPILATION
+#define COMMONAPI_INTERNAL_COMPILATION
+#endif
+
+#include <CommonAPI/DBus/DBusAddress.hpp>
+#include <CommonAPI/DBus/DBusAddressTranslator.hpp>
+
+// The library containing the generated proxies and stub adapters of all test
+// interfaces. Its path is passed as first argument by ctest.
+static std::string interfacesLibrary = "libDBusStartupInterfaces.so";
+
+TEST(DBusStartupBenchmark, LoadLibraryOfGeneratedInterfaces) {
+    // Loading runs the static initializers of all generated sources.
+    auto start = std::chrono::steady_clock::now();
+    void *library = dlopen(interfacesLibrary.c_str(), RTLD_NOW | RTLD_GLOBAL);
+    auto elapsedLoad = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    ASSERT_TRUE(library != NULL) << dlerror();
+
+    // Initializing the runtime initializes the D-Bus factory, which inserts the
+    // deployment defined addresses of all interfaces.
+    start = std::chrono::steady_clock::now();
+    std::shared_ptr<CommonAPI::Runtime> runtime = CommonAPI::Runtime::get();
+    auto elapsedInit = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    ASSERT_TRUE((bool)runtime);
+
+    // The first lookup after the initialization. The instance is deployed with an
+    // address that differs from the default mapping (fakeLegacyService.fdepl).
+    start = std::chrono::steady_clock::now();
+    CommonAPI::DBus::DBusAddress dbusAddress;
+    CommonAPI::DBus::DBusAddressTranslator::get()->translate(
+            CommonAPI::Address("local",
+                               "fake.legacy.service.LegacyInterface:v1_0",
+                               "fake.legacy.service.DeployedAddress"),
+            dbusAddress);
+    auto elapsedLookup = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    EXPECT_EQ("fake.legacy.service.deployed", dbusAddress.getService());
+    EXPECT_EQ("/fake/legacy/service/deployed", dbusAddress.getObjectPath());
+    EXPECT_EQ("fake.legacy.service.DeployedInterface", dbusAddress.getInterface());
+
+    printf("[ BENCH    ] load %.3f ms, runtime initialization %.3f ms, first lookup %.3f ms\n",
+           double(elapsedLoad.count()) / 1000.0,
+           double(elapsedInit.count()) / 1000.0,
+           double(elapsedLookup.count()) / 1000.0);
+    fflush(stdout);
+}
+
+#ifndef __NO_MAIN__
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    if (argc > 1) {
+        interfacesLibrary = argv[1];
+    }
+    return RUN_ALL_TESTS();
+}
+#endif
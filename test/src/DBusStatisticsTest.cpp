@@ -0,0 +1,212 @@
+// Copyright (C) 2015 Bayerische Motoren Werke Aktiengesellschaft (BMW AG)
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef _GLIBCXX_USE_NANOSLEEP
+#define _GLIBCXX_USE_NANOSLEEP
+#endif
+
+#include <CommonAPI/CommonAPI.hpp>
+
+#ifndef COMMONAPI_INTERNAL_COMPILATION
+#define COMMONAPI_INTERNAL_COMPILATION
+#endif
+
+#include <CommonAPI/DBus/DBusAddressTranslator.hpp>
+#include <CommonAPI/DBus/DBusConnection.hpp>
+#include <CommonAPI/DBus/DBusInputStream.hpp>
+#include <CommonAPI/DBus/DBusMessage.hpp>
+
+#include <v1/test/statistics/TestInterfaceProxy.hpp>
+#include <v1/test/statistics/TestInterfaceStubDefault.hpp>
+#include <v1/test/statistics/TestInterfaceDBusStatistics.hpp>
+#include <v1/test/statistics/TestInterfaceDBusStubAdapter.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+static const std::string domain = "local";
+static const std::string instance = "CommonAPI.DBus.tests.DBusStatisticsTestService";
+static const std::string otherInstance = "CommonAPI.DBus.tests.DBusStatisticsTestService2";
+static const std::string unavailableInstance = "CommonAPI.DBus.tests.DBusStatisticsTestService3";
+
+#define VERSION v1_0
+
+// statistics.fidl is generated with the statistics interface of the stub adapters (-si).
+class StatisticsTest: public ::testing::Test {
+
+protected:
+    void SetUp() {
+        runtime_ = CommonAPI::Runtime::get();
+
+        connection_ = CommonAPI::DBus::DBusConnection::getBus(CommonAPI::DBus::DBusType_t::SESSION, "statisticsConnection");
+        ASSERT_TRUE(connection_->connect());
+
+        stub_ = std::make_shared<VERSION::test::statistics::TestInterfaceStubDefault>();
+        ASSERT_TRUE(runtime_->registerService(domain, instance, stub_, "serviceConnection"));
+        otherStub_ = std::make_shared<VERSION::test::statistics::TestInterfaceStubDefault>();
+        ASSERT_TRUE(runtime_->registerService(domain, otherInstance, otherStub_, "serviceConnection"));
+
+        proxy_ = runtime_->buildProxy<VERSION::test::statistics::TestInterfaceProxy>(domain, instance, "clientConnection");
+        ASSERT_TRUE((bool)proxy_);
+        for (int i = 0; !proxy_->isAvailable() && i < 100; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ASSERT_TRUE(proxy_->isAvailable());
+    }
+
+    virtual void TearDown() {
+        proxy_.reset();
+        runtime_->unregisterService(domain, VERSION::test::statistics::TestInterface::getInterface(), instance);
+        runtime_->unregisterService(domain, VERSION::test::statistics::TestInterface::getInterface(), otherInstance);
+        stub_.reset();
+        otherStub_.reset();
+        connection_->disconnect();
+        std::this_thread::sleep_for(std::chrono::microseconds(300000));
+    }
+
+    // Calls GetStatistics at the object path of the given instance; empty if it fails.
+    std::string getStatistics(const std::string &_instance) {
+        CommonAPI::DBus::DBusAddress itsAddress;
+        CommonAPI::DBus::DBusAddressTranslator::get()->translate(
+            CommonAPI::Address(domain, VERSION::test::statistics::TestInterface::getInterface(), _instance), itsAddress);
+
+        CommonAPI::DBus::DBusMessage itsCall = CommonAPI::DBus::DBusMessage::createMethodCall(
+            CommonAPI::DBus::DBusAddress(itsAddress.getService(), itsAddress.getObjectPath(), "org.genivi.commonapi.Statistics"),
+            "GetStatistics");
+
+        CommonAPI::DBus::DBusError itsError;
+        CommonAPI::CallInfo itsInfo(1000);
+        CommonAPI::DBus::DBusMessage itsReply = connection_->sendDBusMessageWithReplyAndBlock(itsCall, itsError, &itsInfo);
+        if (!itsReply || itsReply.isErrorType()) {
+            return "";
+        }
+
+        std::string itsStatistics;
+        CommonAPI::DBus::DBusInputStream itsInput(itsReply);
+        itsInput >> itsStatistics;
+        return itsStatistics;
+    }
+
+    // The value of the sample of the given metric and method; -1 if there is none.
+    static int64_t getSample(const std::string &_statistics, const std::string &_name,
+                             const std::string &_interface, const std::string &_member, const std::string &_signature) {
+        const std::string itsLabels = "commonapi_dbus_" + _name + "{interface=\"" + _interface
+            + "\",member=\"" + _member + "\",signature=\"" + _signature + "\"} ";
+        std::istringstream itsText(_statistics);
+        std::string itsLine;
+        while (std::getline(itsText, itsLine)) {
+            if (itsLine.compare(0, itsLabels.size(), itsLabels) == 0) {
+                return std::stoll(itsLine.substr(itsLabels.size()));
+            }
+        }
+        return -1;
+    }
+
+    // Every call is in exactly one latency bucket.
+    static uint64_t getBucketedCalls(const VERSION::test::statistics::TestInterfaceDBusStatistics::Counters &_counters) {
+        uint64_t itsCalls(0);
+        for (std::size_t i = 0; i < VERSION::test::statistics::TestInterfaceDBusStatistics::numberOfLatencyBuckets; i++) {
+            itsCalls += _counters.latencies_[i].load();
+        }
+        return itsCalls;
+    }
+
+    std::shared_ptr<CommonAPI::Runtime> runtime_;
+    std::shared_ptr<CommonAPI::DBus::DBusConnection> connection_;
+    std::shared_ptr<VERSION::test::statistics::TestInterfaceStubDefault> stub_;
+    std::shared_ptr<VERSION::test::statistics::TestInterfaceStubDefault> otherStub_;
+    std::shared_ptr<VERSION::test::statistics::TestInterfaceProxy<>> proxy_;
+};
+
+TEST_F(StatisticsTest, GetStatisticsReportsTheCallsOfItsInstance) {
+    CommonAPI::CallStatus callStatus;
+    uint32_t result;
+    for (uint32_t i = 0; i < 3; i++) {
+        proxy_->testMethod(i, callStatus, result);
+        ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, callStatus);
+    }
+    proxy_->baseMethod(callStatus);
+    ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, callStatus);
+
+    const std::string statistics = getStatistics(instance);
+    ASSERT_FALSE(statistics.empty());
+    EXPECT_NE(std::string::npos, statistics.find("# TYPE commonapi_dbus_calls_total counter\n"));
+    EXPECT_NE(std::string::npos, statistics.find("# TYPE commonapi_dbus_dispatch_latency_p99_microseconds gauge\n"));
+    EXPECT_EQ(3, getSample(statistics, "calls_total", "test.statistics.TestInterface", "testMethod", "u"));
+    EXPECT_EQ(0, getSample(statistics, "errors_total", "test.statistics.TestInterface", "testMethod", "u"));
+    EXPECT_EQ(0, getSample(statistics, "dispatch_in_flight", "test.statistics.TestInterface", "testMethod", "u"));
+    EXPECT_EQ(1, getSample(statistics, "calls_total", "test.statistics.BaseInterface", "baseMethod", ""));
+    EXPECT_LT(0, getSample(statistics, "dispatch_latency_p99_microseconds", "test.statistics.TestInterface", "testMethod", "u"));
+
+    // The other instance of the same interface was not called.
+    const std::string otherStatistics = getStatistics(otherInstance);
+    ASSERT_FALSE(otherStatistics.empty());
+    EXPECT_EQ(0, getSample(otherStatistics, "calls_total", "test.statistics.TestInterface", "testMethod", "u"));
+    EXPECT_EQ(0, getSample(otherStatistics, "calls_total", "test.statistics.BaseInterface", "baseMethod", ""));
+}
+
+TEST_F(StatisticsTest, ProxyAndStubCountCallsErrorsAndLatencies) {
+    typedef VERSION::test::statistics::TestInterfaceDBusStatistics Statistics;
+    Statistics &proxyStatistics = Statistics::getProxyStatistics();
+    proxyStatistics.reset();
+
+    std::shared_ptr<VERSION::test::statistics::TestInterfaceDBusStubAdapterInternal<>> stubAdapter
+        = std::dynamic_pointer_cast<VERSION::test::statistics::TestInterfaceDBusStubAdapterInternal<>>(stub_->getStubAdapter());
+    ASSERT_TRUE((bool)stubAdapter);
+    std::shared_ptr<Statistics> stubStatistics = stubAdapter->getTestInterfaceDBusStatistics();
+    ASSERT_TRUE((bool)stubStatistics);
+
+    const std::size_t testMethod = 0;
+    ASSERT_STREQ("testMethod", Statistics::getMethodName(testMethod));
+    ASSERT_STREQ("u", Statistics::getMethodSignature(testMethod));
+
+    CommonAPI::CallStatus callStatus;
+    uint32_t result;
+    for (uint32_t i = 0; i < 5; i++) {
+        proxy_->testMethod(i, callStatus, result);
+        ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, callStatus);
+    }
+    std::promise<CommonAPI::CallStatus> asyncStatus;
+    proxy_->testMethodAsync(5, [&asyncStatus](const CommonAPI::CallStatus &_status, uint32_t) {
+        asyncStatus.set_value(_status);
+    });
+    ASSERT_EQ(CommonAPI::CallStatus::SUCCESS, asyncStatus.get_future().get());
+
+    // Nobody offers this instance, so its calls fail.
+    auto unavailableProxy = runtime_->buildProxy<VERSION::test::statistics::TestInterfaceProxy>(domain, unavailableInstance, "clientConnection");
+    ASSERT_TRUE((bool)unavailableProxy);
+    unavailableProxy->testMethod(0, callStatus, result);
+    EXPECT_NE(CommonAPI::CallStatus::SUCCESS, callStatus);
+
+    const Statistics::Counters &proxyCounters = proxyStatistics.getCounters(testMethod);
+    EXPECT_EQ(7u, proxyCounters.calls_.load());
+    EXPECT_EQ(1u, proxyCounters.errors_.load());
+    EXPECT_EQ(0u, proxyCounters.inFlight_.load());
+    EXPECT_EQ(7u, getBucketedCalls(proxyCounters));
+    EXPECT_LT(0u, proxyStatistics.getLatencyPercentile(testMethod, 50));
+
+    const Statistics::Counters &stubCounters = stubStatistics->getCounters(testMethod);
+    EXPECT_EQ(6u, stubCounters.calls_.load());
+    EXPECT_EQ(0u, stubCounters.errors_.load());
+    EXPECT_EQ(0u, stubCounters.inFlight_.load());
+    EXPECT_EQ(6u, getBucketedCalls(stubCounters));
+    EXPECT_LE(stubStatistics->getLatencyPercentile(testMethod, 50), stubStatistics->getLatencyPercentile(testMethod, 99));
+
+    stubStatistics->reset();
+    EXPECT_EQ(0u, stubCounters.calls_.load());
+    EXPECT_EQ(0u, getBucketedCalls(stubCounters));
+    EXPECT_EQ(0u, stubStatistics->getLatencyPercentile(testMethod, 99));
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,756 @@
+// Copyright (C) 2015 Bayerische Motoren Werke Aktiengesellschaft (BMW AG)
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef EPOLL_MAIN_LOOP_H_
+#define EPOLL_MAIN_LOOP_H_
+
+#if !defined (COMMONAPI_INTERNAL_COMPILATION)
+#define COMMONAPI_INTERNAL_COMPILATION
+#endif
+
+#include <CommonAPI/MainLoopContext.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace CommonAPI {
+
+/*
+ * Work-stealing thread pool: every worker owns a task deque, takes work from its
+ * front and steals from the back of the other deques when its own is empty.
+ */
+class DispatchWorkerPool {
+ public:
+    explicit DispatchWorkerPool(size_t numWorkers)
+        : queues_(numWorkers == 0 ? 1 : numWorkers),
+          pending_(0),
+          nextQueue_(0),
+          isStopping_(false) {
+        for (size_t i = 0; i < queues_.size(); i++) {
+            workers_.push_back(std::thread(&DispatchWorkerPool::work, this, i));
+        }
+    }
+
+    ~DispatchWorkerPool() {
+        {
+            std::lock_guard<std::mutex> itsLock(mutex_);
+            isStopping_ = true;
+        }
+        condition_.notify_all();
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    void submit(std::function<void()> _task) {
+        TaskQueue &queue = queues_[nextQueue_++ % queues_.size()];
+        {
+            std::lock_guard<std::mutex> itsLock(queue.mutex_);
+            queue.tasks_.push_back(std::move(_task));
+        }
+        {
+            std::lock_guard<std::mutex> itsLock(mutex_);
+            pending_++;
+        }
+        condition_.notify_one();
+    }
+
+ private:
+    struct TaskQueue {
+        std::mutex mutex_;
+        std::deque<std::function<void()>> tasks_;
+    };
+
+    bool take(size_t _worker, std::function<void()>& _task) {
+        for (size_t i = 0; i < queues_.size(); i++) {
+            TaskQueue &queue = queues_[(_worker + i) % queues_.size()];
+            std::lock_guard<std::mutex> itsLock(queue.mutex_);
+            if (!queue.tasks_.empty()) {
+                if (i == 0) {
+                    _task = std::move(queue.tasks_.front());
+                    queue.tasks_.pop_front();
+                } else {
+                    _task = std::move(queue.tasks_.back());
+                    queue.tasks_.pop_back();
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(size_t _worker) {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> itsLock(mutex_);
+                condition_.wait(itsLock, [this]() { return isStopping_ || pending_ > 0; });
+                if (pending_ == 0) {
+                    return;
+                }
+                pending_--;
+            }
+            // A task is reserved for this worker; it is in one of the deques.
+            std::function<void()> task;
+            while (!take(_worker, task));
+            task();
+        }
+    }
+
+    std::vector<TaskQueue> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    size_t pending_;
+    std::atomic<size_t> nextQueue_;
+    bool isStopping_;
+};
+
+/*
+ * Linux main loop for one or more MainLoopContexts, used like the DemoMainLoop.
+ *
+ * Watches stay in the epoll interest list, so an iteration only touches the file
+ * descriptors that are ready and (de)registering a watch is a hash table update plus
+ * one epoll_ctl. Timeouts are kept in a min-heap ordered by ready time; a single
+ * timerfd is armed for the earliest one. Dispatch sources are prepared and checked
+ * on every iteration as the MainLoopContext contract requires.
+ *
+ * With numWorkers > 0 the loop only polls; ready watches, timeouts and dispatch
+ * sources are dispatched on a DispatchWorkerPool. Each of them is handed to at most
+ * one worker at a time and is not polled again before that worker is done, so the
+ * messages of a connection (and thereby of every object path on it) keep their
+ * order while different connections are served in parallel. A context maps to one
+ * connection; attach one context per connection to spread a process over all cores.
+ *
+ * As with the DemoMainLoop, the loop takes ownership of watches, timeouts and
+ * dispatch sources: deregistered objects are deleted at the start of the next
+ * iteration that finds them idle, the remaining ones when the loop is destroyed.
+ */
+class EpollMainLoop {
+ public:
+    EpollMainLoop() = delete;
+    EpollMainLoop(const EpollMainLoop&) = delete;
+    EpollMainLoop& operator=(const EpollMainLoop&) = delete;
+    EpollMainLoop(EpollMainLoop&&) = delete;
+    EpollMainLoop& operator=(EpollMainLoop&&) = delete;
+
+    explicit EpollMainLoop(std::shared_ptr<MainLoopContext> context, size_t numWorkers = 0)
+                        : hasToStop_(false),
+                          running_(false),
+                          isTimerArmed_(false),
+                          armedReadyTime_(0) {
+        epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd_ == -1) {
+            std::perror("EpollMainLoop::epoll_create1");
+        }
+        wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        timerFd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        addInternalFileDescriptor(wakeFd_);
+        addInternalFileDescriptor(timerFd_);
+
+        if (numWorkers > 0) {
+            workers_ = std::make_shared<DispatchWorkerPool>(numWorkers);
+        }
+
+        attachContext(context);
+    }
+
+    ~EpollMainLoop() {
+        for (auto &attached : contexts_) {
+            attached.context_->unsubscribeForDispatchSources(
+                    attached.dispatchSourceListenerSubscription_);
+            attached.context_->unsubscribeForWatches(attached.watchListenerSubscription_);
+            attached.context_->unsubscribeForTimeouts(attached.timeoutSourceListenerSubscription_);
+            attached.context_->unsubscribeForWakeupEvents(attached.wakeupListenerSubscription_);
+        }
+
+        // Joins the workers, nothing is dispatched afterwards.
+        workers_.reset();
+
+        cleanup();
+
+        ::close(timerFd_);
+        ::close(wakeFd_);
+        ::close(epollFd_);
+    }
+
+    /**
+     * \brief Adds the watches, timeouts and dispatch sources of another context.
+     */
+    void attachContext(std::shared_ptr<MainLoopContext> context) {
+        AttachedContext attached;
+        attached.context_ = context;
+        attached.dispatchSourceListenerSubscription_ = context->subscribeForDispatchSources(
+                std::bind(&EpollMainLoop::registerDispatchSource, this,
+                        std::placeholders::_1, std::placeholders::_2),
+                std::bind(&EpollMainLoop::unregisterDispatchSource,
+                        this, std::placeholders::_1));
+        attached.watchListenerSubscription_ = context->subscribeForWatches(
+                std::bind(&EpollMainLoop::registerWatch, this,
+                        std::placeholders::_1, std::placeholders::_2),
+                std::bind(&EpollMainLoop::unregisterWatch, this,
+                        std::placeholders::_1));
+        attached.timeoutSourceListenerSubscription_ = context->subscribeForTimeouts(
+                std::bind(&EpollMainLoop::registerTimeout, this,
+                        std::placeholders::_1, std::placeholders::_2),
+                std::bind(&EpollMainLoop::unregisterTimeout, this,
+                        std::placeholders::_1));
+        attached.wakeupListenerSubscription_ = context->subscribeForWakeupEvents(
+                std::bind(&EpollMainLoop::wakeup, this));
+        contexts_.push_back(attached);
+    }
+
+    /**
+     * \brief Runs the mainloop indefinitely until stop() is called.
+     *
+     * The given timeout (milliseconds) bounds each wait for events.
+     */
+    void run(const int64_t& timeoutInterval = TIMEOUT_INFINITE) {
+        running_ = true;
+        hasToStop_ = false;
+        while (!hasToStop_) {
+            doSingleIteration(timeoutInterval);
+        }
+        running_ = false;
+    }
+
+    void stop() {
+        hasToStop_ = true;
+        wakeup();
+    }
+
+    /**
+     * \brief Executes a single cycle of the mainloop.
+     *
+     * Prepares the dispatch sources, waits for ready file descriptors, elapsed
+     * timeouts or a wakeup (at most the given timeout in milliseconds, no wait at all
+     * if something is ready already), checks the dispatch sources and dispatches
+     * everything that is ready: timeouts first, then watches, then dispatch sources,
+     * each group in order of priority. With workers, dispatching means handing over
+     * to the pool; the iteration does not wait for it.
+     */
+    void doSingleIteration(const int64_t& timeout = TIMEOUT_INFINITE) {
+        deleteUnregisteredObjects();
+
+        std::vector<std::shared_ptr<SourceEntry>> sources;
+        std::vector<std::shared_ptr<SourceEntry>> readySources;
+        std::vector<std::shared_ptr<TimeoutEntry>> readyTimeouts;
+        std::vector<std::pair<std::shared_ptr<WatchEntry>, unsigned int>> readyWatches;
+
+        {
+            std::lock_guard<std::mutex> itsLock(mutex_);
+            sources.reserve(sources_.size());
+            for (auto &source : sources_) {
+                sources.push_back(source.second);
+            }
+        }
+
+        int64_t waitTimeout = timeout;
+        for (auto &source : sources) {
+            int64_t sourceTimeout = TIMEOUT_INFINITE;
+            if (source->isDeleted_ || source->isBusy_) {
+                continue;
+            }
+            if (source->source_->prepare(sourceTimeout)) {
+                source->isReady_ = true;
+                readySources.push_back(source);
+            } else if (sourceTimeout > 0 && sourceTimeout < waitTimeout) {
+                waitTimeout = sourceTimeout;
+            }
+        }
+
+        collectElapsedTimeouts(readyTimeouts);
+
+        if (!readySources.empty() || !readyTimeouts.empty()) {
+            waitTimeout = TIMEOUT_NONE;
+        }
+
+        std::array<struct epoll_event, maxEvents_> events;
+        int numEvents = epoll_wait(epollFd_, events.data(), int(events.size()), toEpollTimeout(waitTimeout));
+        for (int i = 0; i < numEvents; i++) {
+            const int fd = events[size_t(i)].data.fd;
+            if (fd == wakeFd_) {
+                wakeupAck();
+            } else if (fd == timerFd_) {
+                timerAck();
+            } else {
+                collectReadyWatches(fd, events[size_t(i)].events, readyWatches);
+            }
+        }
+
+        collectElapsedTimeouts(readyTimeouts);
+
+        for (auto &source : sources) {
+            if (!source->isDeleted_ && !source->isBusy_ && !source->isReady_ && source->source_->check()) {
+                source->isReady_ = true;
+                readySources.push_back(source);
+            }
+        }
+
+        std::stable_sort(readyTimeouts.begin(), readyTimeouts.end(),
+                [](const std::shared_ptr<TimeoutEntry>& _lhs, const std::shared_ptr<TimeoutEntry>& _rhs) {
+                    return _lhs->priority_ < _rhs->priority_;
+                });
+        std::stable_sort(readyWatches.begin(), readyWatches.end(),
+                [](const std::pair<std::shared_ptr<WatchEntry>, unsigned int>& _lhs,
+                   const std::pair<std::shared_ptr<WatchEntry>, unsigned int>& _rhs) {
+                    return _lhs.first->priority_ < _rhs.first->priority_;
+                });
+        std::stable_sort(readySources.begin(), readySources.end(),
+                [](const std::shared_ptr<SourceEntry>& _lhs, const std::shared_ptr<SourceEntry>& _rhs) {
+                    return _lhs->priority_ < _rhs->priority_;
+                });
+
+        for (auto &timeout : readyTimeouts) {
+            if (!timeout->isDeleted_) {
+                execute(timeout, [timeout]() {
+                    if (!timeout->isDeleted_) {
+                        timeout->timeout_->dispatch();
+                    }
+                }, [this, timeout]() {
+                    rescheduleTimeout(timeout);
+                });
+            }
+        }
+        for (auto &ready : readyWatches) {
+            std::shared_ptr<WatchEntry> watch = ready.first;
+            const unsigned int flags = ready.second;
+            execute(watch, [watch, flags]() {
+                if (!watch->isDeleted_) {
+                    watch->watch_->dispatch(flags);
+                }
+            }, [this, watch]() {
+                if (workers_) {
+                    // Re-enable the one-shot registration only once the watch is idle.
+                    std::lock_guard<std::mutex> itsLock(mutex_);
+                    updateFileDescriptor(watch->fd_);
+                }
+            });
+        }
+        for (auto &source : readySources) {
+            source->isReady_ = false;
+            execute(source, [source]() {
+                while (!source->isDeleted_ && source->source_->dispatch());
+            });
+        }
+
+        std::lock_guard<std::mutex> itsLock(mutex_);
+        armTimer();
+    }
+
+    void wakeup() {
+        int64_t wake = 1;
+        if (::write(wakeFd_, &wake, sizeof(int64_t)) == -1) {
+            std::perror("EpollMainLoop::wakeup");
+        }
+    }
+
+ private:
+    static const size_t maxEvents_ = 64;
+
+    struct AttachedContext {
+        std::shared_ptr<MainLoopContext> context_;
+        DispatchSourceListenerSubscription dispatchSourceListenerSubscription_;
+        WatchListenerSubscription watchListenerSubscription_;
+        TimeoutSourceListenerSubscription timeoutSourceListenerSubscription_;
+        WakeupListenerSubscription wakeupListenerSubscription_;
+    };
+
+    struct SourceEntry {
+        SourceEntry(DispatchSource* _source, DispatchPriority _priority)
+            : source_(_source), priority_(_priority), isDeleted_(false), isBusy_(false), isReady_(false) {}
+
+        DispatchSource* source_;
+        DispatchPriority priority_;
+        std::atomic<bool> isDeleted_;
+        std::atomic<bool> isBusy_; /* handed to a worker and not finished yet */
+        bool isReady_; /* only accessed by the thread running the loop */
+    };
+
+    struct WatchEntry {
+        WatchEntry(Watch* _watch, int _fd, uint32_t _events, DispatchPriority _priority)
+            : watch_(_watch), fd_(_fd), events_(_events), priority_(_priority), isDeleted_(false), isBusy_(false) {}
+
+        Watch* watch_;
+        int fd_;
+        uint32_t events_;
+        DispatchPriority priority_;
+        std::atomic<bool> isDeleted_;
+        std::atomic<bool> isBusy_;
+    };
+
+    struct TimeoutEntry {
+        TimeoutEntry(Timeout* _timeout, DispatchPriority _priority)
+            : timeout_(_timeout), priority_(_priority), isDeleted_(false), isBusy_(false) {}
+
+        Timeout* timeout_;
+        DispatchPriority priority_;
+        std::atomic<bool> isDeleted_;
+        std::atomic<bool> isBusy_;
+    };
+
+    struct QueuedTimeout {
+        int64_t readyTime_;
+        std::shared_ptr<TimeoutEntry> entry_;
+
+        bool operator>(const QueuedTimeout& _other) const {
+            return readyTime_ > _other.readyTime_;
+        }
+    };
+
+    static int toEpollTimeout(int64_t _timeout) {
+        if (_timeout < 0 || _timeout >= INT_MAX) {
+            return -1;
+        }
+        return int(_timeout);
+    }
+
+    // Runs _task right away or, with workers, on the pool while _entry is marked busy.
+    // _done runs after _task once _entry is idle again.
+    template<class _Entry>
+    void execute(const std::shared_ptr<_Entry>& _entry, std::function<void()> _task,
+                 std::function<void()> _done = nullptr) {
+        if (!workers_) {
+            _task();
+            if (_done) {
+                _done();
+            }
+            return;
+        }
+        _entry->isBusy_ = true;
+        workers_->submit([this, _entry, _task, _done]() {
+            _task();
+            _entry->isBusy_ = false;
+            if (_done) {
+                _done();
+            }
+            wakeup();
+        });
+    }
+
+    void addInternalFileDescriptor(int _fd) {
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = 0;
+        event.data.fd = _fd;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, _fd, &event) == -1) {
+            std::perror("EpollMainLoop::addInternalFileDescriptor");
+        }
+    }
+
+    void wakeupAck() {
+        int64_t buffer;
+        while (::read(wakeFd_, &buffer, sizeof(int64_t)) == sizeof(buffer));
+    }
+
+    void timerAck() {
+        uint64_t expirations;
+        while (::read(timerFd_, &expirations, sizeof(uint64_t)) == sizeof(expirations));
+        std::lock_guard<std::mutex> itsLock(mutex_);
+        isTimerArmed_ = false;
+    }
+
+    // Must be called with mutex_ held. Keeps the timerfd armed for the earliest
+    // queued timeout; deregistered timeouts are dropped from the top of the queue.
+    void armTimer() {
+        while (!timeoutQueue_.empty() && timeoutQueue_.top().entry_->isDeleted_) {
+            timeoutQueue_.pop();
+        }
+
+        struct itimerspec timerValue = {};
+        if (timeoutQueue_.empty()) {
+            if (!isTimerArmed_) {
+                return;
+            }
+            isTimerArmed_ = false;
+        } else {
+            const int64_t readyTime = timeoutQueue_.top().readyTime_;
+            if (isTimerArmed_ && readyTime == armedReadyTime_) {
+                return;
+            }
+            int64_t interval = readyTime - getCurrentTimeInMs();
+            if (interval > 0) {
+                timerValue.it_value.tv_sec = time_t(interval / 1000);
+                timerValue.it_value.tv_nsec = long((interval % 1000) * 1000000);
+            } else {
+                timerValue.it_value.tv_nsec = 1;
+            }
+            isTimerArmed_ = true;
+            armedReadyTime_ = readyTime;
+        }
+
+        if (timerfd_settime(timerFd_, 0, &timerValue, NULL) == -1) {
+            std::perror("EpollMainLoop::armTimer");
+        }
+    }
+
+    void collectElapsedTimeouts(std::vector<std::shared_ptr<TimeoutEntry>>& _readyTimeouts) {
+        std::lock_guard<std::mutex> itsLock(mutex_);
+        const int64_t now = getCurrentTimeInMs();
+        while (!timeoutQueue_.empty() && timeoutQueue_.top().readyTime_ <= now) {
+            std::shared_ptr<TimeoutEntry> entry = timeoutQueue_.top().entry_;
+            timeoutQueue_.pop();
+            if (entry->isDeleted_) {
+                continue;
+            }
+            // The timeout may have been rescheduled after it was queued
+            const int64_t readyTime = entry->timeout_->getReadyTime();
+            if (readyTime > now) {
+                timeoutQueue_.push({ readyTime, entry });
+                continue;
+            }
+            _readyTimeouts.push_back(entry);
+        }
+    }
+
+    void rescheduleTimeout(const std::shared_ptr<TimeoutEntry>& _entry) {
+        std::lock_guard<std::mutex> itsLock(mutex_);
+        if (_entry->isDeleted_) {
+            return;
+        }
+        const int64_t now = getCurrentTimeInMs();
+        int64_t readyTime = _entry->timeout_->getReadyTime();
+        if (readyTime <= now) {
+            readyTime = now + _entry->timeout_->getTimeoutInterval();
+        }
+        timeoutQueue_.push({ readyTime, _entry });
+    }
+
+    void collectReadyWatches(int _fd, uint32_t _events,
+            std::vector<std::pair<std::shared_ptr<WatchEntry>, unsigned int>>& _readyWatches) {
+        std::lock_guard<std::mutex> itsLock(mutex_);
+        auto found = fileDescriptors_.find(_fd);
+        if (found == fileDescriptors_.end()) {
+            return;
+        }
+        bool isAnyBusy(false), isAnyReady(false);
+        for (auto &watch : found->second) {
+            if (watch->isBusy_) {
+                isAnyBusy = true;
+                continue;
+            }
+            const uint32_t flags = _events & (watch->events_ | POLLERR | POLLHUP);
+            if (flags) {
+                _readyWatches.push_back({ watch, (unsigned int)flags });
+                isAnyReady = true;
+            }
+        }
+        // With workers the descriptor is registered one-shot. Whoever finishes last
+        // re-enables it; if nobody got work, that is done here.
+        if (workers_ && !isAnyBusy && !isAnyReady) {
+            updateFileDescriptor(_fd);
+        }
+    }
+
+    // Must be called with mutex_ held. Brings the epoll registration of _fd in line
+    // with the watches registered for it.
+    void updateFileDescriptor(int _fd) {
+        auto found = fileDescriptors_.find(_fd);
+        if (found == fileDescriptors_.end()) {
+            return;
+        }
+
+        if (found->second.empty()) {
+            fileDescriptors_.erase(found);
+            // The descriptor might have been closed already, which removed it from the set.
+            epoll_ctl(epollFd_, EPOLL_CTL_DEL, _fd, NULL);
+            return;
+        }
+
+        struct epoll_event event;
+        event.events = (workers_ ? uint32_t(EPOLLONESHOT) : 0);
+        for (auto &watch : found->second) {
+            event.events |= watch->events_;
+        }
+        event.data.u64 = 0;
+        event.data.fd = _fd;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_MOD, _fd, &event) == -1) {
+            if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, _fd, &event) == -1) {
+                std::perror("EpollMainLoop::updateFileDescriptor");
+            }
+        }
+    }
+
+    void registerDispatchSource(DispatchSource* dispatchSource, const DispatchPriority dispatchPriority) {
+        auto entry = std::make_shared<SourceEntry>(dispatchSource, dispatchPriority);
+        std::lock_guard<std::mutex> itsLock(mutex_);
+        unregisteredDispatchSources_.erase(dispatchSource);
+        auto found = sources_.find(dispatchSource);
+        if (found != sources_.end()) {
+            found->second->isDeleted_ = true;
+        }
+        sources_[dispatchSource] = entry;
+    }
+
+    void unregisterDispatchSource(DispatchSource* dispatchSource) {
+        std::lock_guard<std::mutex> itsLock(mutex_);
+        auto found = sources_.find(dispatchSource);
+        if (found != sources_.end()) {
+            found->second->isDeleted_ = true;
+            unregisteredDispatchSources_[dispatchSource] = found->second;
+            sources_.erase(found);
+        }
+    }
+
+    void registerWatch(Watch* watch, const DispatchPriority dispatchPriority) {
+        const pollfd& fileDescriptor = watch->getAssociatedFileDescriptor();
+        auto entry = std::make_shared<WatchEntry>(watch, fileDescriptor.fd,
+                uint32_t(fileDescriptor.events), dispatchPriority);
+
+        std::lock_guard<std::mutex> itsLock(mutex_);
+        unregisteredWatches_.erase(watch);
+        auto found = watches_.find(watch);
+        if (found != watches_.end()) {
+            removeWatch(found->second);
+        }
+        watches_[watch] = entry;
+        fileDescriptors_[entry->fd_].push_back(entry);
+        updateFileDescriptor(entry->fd_);
+    }
+
+    void unregisterWatch(Watch* watch) {
+        std::lock_guard<std::mutex> itsLock(mutex_);
+        auto found = watches_.find(watch);
+        if (found != watches_.end()) {
+            removeWatch(found->second);
+            unregisteredWatches_[watch] = found->second;
+            watches_.erase(found);
+        }
+    }
+
+    // Must be called with mutex_ held.
+    void removeWatch(const std::shared_ptr<WatchEntry>& _entry) {
+        _entry->isDeleted_ = true;
+        auto &fdWatches = fileDescriptors_[_entry->fd_];
+        fdWatches.erase(std::remove(fdWatches.begin(), fdWatches.end(), _entry), fdWatches.end());
+        updateFileDescriptor(_entry->fd_);
+    }
+
+    void registerTimeout(Timeout* timeout, const DispatchPriority dispatchPriority) {
+        auto entry = std::make_shared<TimeoutEntry>(timeout, dispatchPriority);
+        std::lock_guard<std::mutex> itsLock(mutex_);
+        unregisteredTimeouts_.erase(timeout);
+        auto found = timeouts_.find(timeout);
+        if (found != timeouts_.end()) {
+            found->second->isDeleted_ = true;
+        }
+        timeouts_[timeout] = entry;
+        timeoutQueue_.push({ timeout->getReadyTime(), entry });
+        armTimer();
+    }
+
+    void unregisterTimeout(Timeout* timeout) {
+        std::lock_guard<std::mutex> itsLock(mutex_);
+        auto found = timeouts_.find(timeout);
+        if (found != timeouts_.end()) {
+            found->second->isDeleted_ = true;
+            unregisteredTimeouts_[timeout] = found->second;
+            timeouts_.erase(found);
+        }
+    }
+
+    // Must be called with mutex_ held. Moves the objects that are no longer in use
+    // from _unregistered to _objects.
+    template<class _Object, class _Entry>
+    static void takeIdle(std::unordered_map<_Object*, std::shared_ptr<_Entry>>& _unregistered,
+                         std::vector<_Object*>& _objects) {
+        for (auto it = _unregistered.begin(); it != _unregistered.end();) {
+            if (it->second->isBusy_) {
+                ++it;
+            } else {
+                _objects.push_back(it->first);
+                it = _unregistered.erase(it);
+            }
+        }
+    }
+
+    void deleteUnregisteredObjects() {
+        std::vector<DispatchSource*> dispatchSources;
+        std::vector<Watch*> watches;
+        std::vector<Timeout*> timeouts;
+        {
+            std::lock_guard<std::mutex> itsLock(mutex_);
+            takeIdle(unregisteredDispatchSources_, dispatchSources);
+            takeIdle(unregisteredWatches_, watches);
+            takeIdle(unregisteredTimeouts_, timeouts);
+        }
+        for (auto dispatchSource : dispatchSources) {
+            delete dispatchSource;
+        }
+        for (auto watch : watches) {
+            delete watch;
+        }
+        for (auto timeout : timeouts) {
+            delete timeout;
+        }
+    }
+
+    void cleanup() {
+        deleteUnregisteredObjects();
+
+        std::lock_guard<std::mutex> itsLock(mutex_);
+        for (auto &source : sources_) {
+            delete source.first;
+        }
+        sources_.clear();
+        for (auto &watch : watches_) {
+            delete watch.first;
+        }
+        watches_.clear();
+        fileDescriptors_.clear();
+        for (auto &timeout : timeouts_) {
+            delete timeout.first;
+        }
+        timeouts_.clear();
+        timeoutQueue_ = std::priority_queue<QueuedTimeout, std::vector<QueuedTimeout>, std::greater<QueuedTimeout>>();
+    }
+
+    std::vector<AttachedContext> contexts_;
+
+    int epollFd_;
+    int wakeFd_;
+    int timerFd_;
+
+    std::shared_ptr<DispatchWorkerPool> workers_;
+
+    std::mutex mutex_;
+
+    std::unordered_map<DispatchSource*, std::shared_ptr<SourceEntry>> sources_;
+    std::unordered_map<Watch*, std::shared_ptr<WatchEntry>> watches_;
+    std::unordered_map<int, std::vector<std::shared_ptr<WatchEntry>>> fileDescriptors_;
+    std::unordered_map<Timeout*, std::shared_ptr<TimeoutEntry>> timeouts_;
+    std::priority_queue<QueuedTimeout, std::vector<QueuedTimeout>, std::greater<QueuedTimeout>> timeoutQueue_;
+
+    std::unordered_map<DispatchSource*, std::shared_ptr<SourceEntry>> unregisteredDispatchSources_;
+    std::unordered_map<Watch*, std::shared_ptr<WatchEntry>> unregisteredWatches_;
+    std::unordered_map<Timeout*, std::shared_ptr<TimeoutEntry>> unregisteredTimeouts_;
+
+    std::atomic<bool> hasToStop_;
+    bool running_;
+
+    bool isTimerArmed_;
+    int64_t armedReadyTime_;
+};
+
+} // namespace CommonAPI
+
+#endif /* EPOLL_MAIN_LOOP_H_ */